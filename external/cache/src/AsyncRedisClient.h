@@ -0,0 +1,249 @@
+#pragma once
+#include "RedisClient.h"
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace cache {
+
+// RedisClient 의 비동기 버전. 메서드 구성은 RedisClient 와 같고 마지막 인자로
+// asio completion token 을 받는다.
+//  - 핸들러: 핸들러의 associated executor 에서 호출된다.
+//    세션 executor 에서 받으려면 boost::asio::bind_executor(executor_, handler)
+//    (executor 가 없는 핸들러는 Redis 워커 스레드에서 호출된다)
+//  - boost::asio::use_future: std::future<결과> 반환
+// 실제 Redis 호출은 전용 스레드 풀에서 하므로 io 스레드는 RTT 동안 막히지 않는다.
+class AsyncRedisClient {
+public:
+    explicit AsyncRedisClient(RedisClient& client, std::size_t threads = 4)
+        : client_(client), pool_(threads) {}
+    ~AsyncRedisClient() { pool_.join(); }
+
+    AsyncRedisClient(const AsyncRedisClient&) = delete;
+    AsyncRedisClient& operator=(const AsyncRedisClient&) = delete;
+
+    // 동기 API 가 필요하면 그대로 사용
+    RedisClient& Sync() { return client_; }
+
+    // -----------------------------
+    // Get/Set APIs
+    // -----------------------------
+    template <typename Token>
+    auto Set(std::string key, std::string value, std::optional<std::chrono::seconds> ttl,
+             Token&& token) {
+        return Run<bool>([this, key = std::move(key), value = std::move(value), ttl] {
+            return client_.Set(key, value, ttl);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto Set(std::string key, std::string value, Token&& token) {
+        return Set(std::move(key), std::move(value), std::nullopt, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto Get(std::string key, Token&& token) {
+        return Run<std::optional<std::string>>([this, key = std::move(key)] {
+            return client_.Get(key);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto Del(std::string key, Token&& token) {
+        return Run<void>([this, key = std::move(key)] { client_.Del(key); },
+                         std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto Expire(std::string key, std::chrono::seconds ttl, Token&& token) {
+        return Run<bool>([this, key = std::move(key), ttl] { return client_.Expire(key, ttl); },
+                         std::forward<Token>(token));
+    }
+
+    // -----------------------------
+    // List APIs
+    // -----------------------------
+    template <typename Token>
+    auto LPush(std::string key, std::string value, Token&& token) {
+        return Run<bool>([this, key = std::move(key), value = std::move(value)] {
+            return client_.LPush(key, value);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto RPush(std::string key, std::string value, Token&& token) {
+        return Run<bool>([this, key = std::move(key), value = std::move(value)] {
+            return client_.RPush(key, value);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto LPop(std::string key, Token&& token) {
+        return Run<std::optional<std::string>>([this, key = std::move(key)] {
+            return client_.LPop(key);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto RPop(std::string key, Token&& token) {
+        return Run<std::optional<std::string>>([this, key = std::move(key)] {
+            return client_.RPop(key);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto LRange(std::string key, long long start, long long stop, Token&& token) {
+        return Run<std::vector<std::string>>([this, key = std::move(key), start, stop] {
+            return client_.LRange(key, start, stop);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto LLen(std::string key, Token&& token) {
+        return Run<long long>([this, key = std::move(key)] { return client_.LLen(key); },
+                              std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto LTrim(std::string key, long long start, long long stop, Token&& token) {
+        return Run<bool>([this, key = std::move(key), start, stop] {
+            return client_.LTrim(key, start, stop);
+        }, std::forward<Token>(token));
+    }
+
+    // -----------------------------
+    // Hash APIs
+    // -----------------------------
+    template <typename Token>
+    auto HSet(std::string key, std::string field, std::string value, Token&& token) {
+        return Run<bool>([this, key = std::move(key), field = std::move(field),
+                          value = std::move(value)] { return client_.HSet(key, field, value); },
+                         std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto HGet(std::string key, std::string field, Token&& token) {
+        return Run<std::optional<std::string>>([this, key = std::move(key),
+                                                field = std::move(field)] {
+            return client_.HGet(key, field);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto HDel(std::string key, std::vector<std::string> fields, Token&& token) {
+        return Run<long long>([this, key = std::move(key), fields = std::move(fields)] {
+            return client_.HDel(key, fields);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto HGetAll(std::string key, Token&& token) {
+        return Run<std::unordered_map<std::string, std::string>>([this, key = std::move(key)] {
+            return client_.HGetAll(key);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto HIncrBy(std::string key, std::string field, long long increment, Token&& token) {
+        return Run<long long>([this, key = std::move(key), field = std::move(field), increment] {
+            return client_.HIncrBy(key, field, increment);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto HMSet(std::string key, std::unordered_map<std::string, std::string> kvs, Token&& token) {
+        return Run<bool>([this, key = std::move(key), kvs = std::move(kvs)] {
+            return client_.HMSet(key, kvs);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto HMGet(std::string key, std::vector<std::string> fields, Token&& token) {
+        return Run<std::vector<std::optional<std::string>>>(
+            [this, key = std::move(key), fields = std::move(fields)] {
+                return client_.HMGet(key, fields);
+            }, std::forward<Token>(token));
+    }
+
+    // -----------------------------
+    // ZSet APIs
+    // -----------------------------
+    template <typename Token>
+    auto ZAdd(std::string key, std::string member, double score, Token&& token) {
+        return Run<long long>([this, key = std::move(key), member = std::move(member), score] {
+            return client_.ZAdd(key, member, score);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto ZRem(std::string key, std::vector<std::string> members, Token&& token) {
+        return Run<long long>([this, key = std::move(key), members = std::move(members)] {
+            return client_.ZRem(key, members);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto ZRevRange(std::string key, long long start, long long stop, Token&& token) {
+        return Run<std::vector<std::string>>([this, key = std::move(key), start, stop] {
+            return client_.ZRevRange(key, start, stop);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto ZRange(std::string key, long long start, long long stop, Token&& token) {
+        return Run<std::vector<std::string>>([this, key = std::move(key), start, stop] {
+            return client_.ZRange(key, start, stop);
+        }, std::forward<Token>(token));
+    }
+
+    // -----------------------------
+    // Pipeline / Pub/Sub / Lock
+    // -----------------------------
+    template <typename Token>
+    auto Exec(RedisBatch batch, Token&& token) {
+        return Run<std::vector<BatchReply>>([this, batch = std::move(batch)] {
+            return client_.Exec(batch);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto ExecTransaction(RedisBatch batch, Token&& token) {
+        return Run<std::vector<BatchReply>>([this, batch = std::move(batch)] {
+            return client_.ExecTransaction(batch);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto Publish(std::string channel, std::string message, Token&& token) {
+        return Run<long long>([this, channel = std::move(channel), message = std::move(message)] {
+            return client_.Publish(channel, message);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto AcquireLock(std::string lockKey, std::chrono::seconds ttl, Token&& token) {
+        return Run<bool>([this, lockKey = std::move(lockKey), ttl] {
+            return client_.AcquireLock(lockKey, ttl);
+        }, std::forward<Token>(token));
+    }
+    template <typename Token>
+    auto ReleaseLock(std::string lockKey, Token&& token) {
+        return Run<void>([this, lockKey = std::move(lockKey)] { client_.ReleaseLock(lockKey); },
+                         std::forward<Token>(token));
+    }
+
+private:
+    template <typename R> struct SignatureOf { using type = void(R); };
+    template <typename R>
+    using Signature = typename SignatureOf<R>::type;
+
+    // fn 을 워커 스레드에서 실행하고, 결과로 핸들러를 핸들러의 executor 에서 호출
+    template <typename R, typename Fn, typename Token>
+    auto Run(Fn fn, Token&& token) {
+        return boost::asio::async_initiate<Token, Signature<R>>(
+            [this](auto handler, Fn fn) {
+                auto ex = boost::asio::get_associated_executor(handler, pool_.get_executor());
+                boost::asio::post(pool_, [ex, fn = std::move(fn),
+                                          handler = std::move(handler)]() mutable {
+                    if constexpr (std::is_void_v<R>) {
+                        fn();
+                        boost::asio::post(ex, std::move(handler));
+                    } else {
+                        boost::asio::post(ex, [handler = std::move(handler),
+                                               result = fn()]() mutable {
+                            handler(std::move(result));
+                        });
+                    }
+                });
+            },
+            token, std::move(fn));
+    }
+
+    RedisClient& client_;
+    boost::asio::thread_pool pool_;
+};
+
+template <> struct AsyncRedisClient::SignatureOf<void> { using type = void(); };
+
+} // namespace cache
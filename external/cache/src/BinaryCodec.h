@@ -0,0 +1,254 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cache {
+namespace codec {
+
+// 캐시 값용 바이너리 포맷 (JSON 대신).
+//
+//   [magic 0xC7][schema version][field count varint][field 0][field 1]...
+//
+//  - 정수: varint (부호 있는 타입은 zigzag), bool: 1바이트, double: 8바이트 LE
+//  - 문자열: 길이 varint + 바이트, optional: 있음 여부 1바이트 + 값
+//  - std::tm: UTC epoch 초 (zigzag varint), vector: 개수 varint + 원소
+//
+// 필드 이름은 쓰지 않고 Schema<T>::fields() 의 순서가 곧 포맷이다.
+//  - 필드는 끝에만 추가한다: 옛 값(필드 수가 적음)은 남은 필드를 기본값으로,
+//    새 값(필드 수가 많음)은 아는 필드까지만 읽는다
+//  - 순서/타입을 바꾸면 Schema<T>::version 을 올린다 (옛 값은 DecodeError → 캐시 miss)
+//
+//   template <> struct Schema<Point> {
+//       static constexpr std::uint8_t version = 1;
+//       static constexpr auto fields() {
+//           return std::make_tuple(Field("x", &Point::x), Field("y", &Point::y));
+//       }
+//   };
+//   std::string bin = Encode(p);
+//   Point q = Decode<Point>(bin);
+
+constexpr std::uint8_t kMagic = 0xC7;
+
+struct DecodeError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// 모델별로 특수화한다 (version, fields())
+template <typename T>
+struct Schema;
+
+template <typename C, typename M>
+struct FieldDesc {
+    const char* name;
+    M C::*member;
+};
+
+template <typename C, typename M>
+constexpr FieldDesc<C, M> Field(const char* name, M C::*member) {
+    return {name, member};
+}
+
+class Writer {
+public:
+    explicit Writer(std::string& out) : out_(out) {}
+
+    void Byte(std::uint8_t b) { out_.push_back(static_cast<char>(b)); }
+
+    void Varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            Byte(static_cast<std::uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        Byte(static_cast<std::uint8_t>(v));
+    }
+
+    void Bytes(std::string_view s) {
+        Varint(s.size());
+        out_.append(s.data(), s.size());
+    }
+
+    template <typename V>
+    void Value(const V& v) {
+        if constexpr (std::is_same_v<V, bool>) {
+            Byte(v ? 1 : 0);
+        } else if constexpr (std::is_enum_v<V>) {
+            Value(static_cast<std::underlying_type_t<V>>(v));
+        } else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>) {
+            auto x = static_cast<std::int64_t>(v);
+            Varint((static_cast<std::uint64_t>(x) << 1) ^ static_cast<std::uint64_t>(x >> 63));
+        } else if constexpr (std::is_integral_v<V>) {
+            Varint(static_cast<std::uint64_t>(v));
+        } else if constexpr (std::is_same_v<V, double>) {
+            std::uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            for (int i = 0; i < 8; ++i) Byte(static_cast<std::uint8_t>(bits >> (8 * i)));
+        } else if constexpr (std::is_same_v<V, std::string>) {
+            Bytes(v);
+        } else if constexpr (std::is_same_v<V, std::tm>) {
+            std::tm copy = v;
+            Value(static_cast<std::int64_t>(timegm(&copy)));
+        } else {
+            Compound(v);
+        }
+    }
+
+private:
+    template <typename U>
+    void Compound(const std::optional<U>& v) {
+        Byte(v ? 1 : 0);
+        if (v) Value(*v);
+    }
+    template <typename U>
+    void Compound(const std::vector<U>& v) {
+        Varint(v.size());
+        for (auto& e : v) Value(e);
+    }
+
+    std::string& out_;
+};
+
+class Reader {
+public:
+    explicit Reader(std::string_view in) : in_(in) {}
+
+    bool AtEnd() const { return pos_ >= in_.size(); }
+
+    std::uint8_t Byte() {
+        if (pos_ >= in_.size()) throw DecodeError("codec: truncated");
+        return static_cast<std::uint8_t>(in_[pos_++]);
+    }
+
+    std::uint64_t Varint() {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            auto b = Byte();
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return v;
+        }
+        throw DecodeError("codec: bad varint");
+    }
+
+    std::string_view Bytes() {
+        auto n = Varint();
+        if (n > in_.size() - pos_) throw DecodeError("codec: truncated");
+        auto s = in_.substr(pos_, n);
+        pos_ += n;
+        return s;
+    }
+
+    template <typename V>
+    void Value(V& v) {
+        if constexpr (std::is_same_v<V, bool>) {
+            v = Byte() != 0;
+        } else if constexpr (std::is_enum_v<V>) {
+            std::underlying_type_t<V> raw{};
+            Value(raw);
+            v = static_cast<V>(raw);
+        } else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>) {
+            auto u = Varint();
+            v = static_cast<V>(static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1));
+        } else if constexpr (std::is_integral_v<V>) {
+            v = static_cast<V>(Varint());
+        } else if constexpr (std::is_same_v<V, double>) {
+            std::uint64_t bits = 0;
+            for (int i = 0; i < 8; ++i) bits |= static_cast<std::uint64_t>(Byte()) << (8 * i);
+            std::memcpy(&v, &bits, sizeof(bits));
+        } else if constexpr (std::is_same_v<V, std::string>) {
+            v.assign(Bytes());
+        } else if constexpr (std::is_same_v<V, std::tm>) {
+            std::int64_t secs = 0;
+            Value(secs);
+            std::time_t t = static_cast<std::time_t>(secs);
+            v = std::tm{};
+            gmtime_r(&t, &v);
+        } else {
+            Compound(v);
+        }
+    }
+
+private:
+    template <typename U>
+    void Compound(std::optional<U>& v) {
+        if (Byte()) {
+            U inner{};
+            Value(inner);
+            v = std::move(inner);
+        } else {
+            v.reset();
+        }
+    }
+    template <typename U>
+    void Compound(std::vector<U>& v) {
+        auto n = Varint();
+        // 원소당 최소 1바이트: 잘못된 개수로 큰 할당을 하지 않도록
+        if (n > in_.size() - pos_) throw DecodeError("codec: bad length");
+        v.clear();
+        v.reserve(n);
+        for (std::uint64_t i = 0; i < n; ++i) {
+            U e{};
+            Value(e);
+            v.push_back(std::move(e));
+        }
+    }
+
+    std::string_view in_;
+    std::size_t pos_ = 0;
+};
+
+template <typename T>
+void EncodeTo(std::string& out, const T& value) {
+    constexpr auto fields = Schema<T>::fields();
+    Writer w(out);
+    w.Byte(kMagic);
+    w.Byte(Schema<T>::version);
+    w.Varint(std::tuple_size_v<std::decay_t<decltype(fields)>>);
+    std::apply([&](const auto&... f) { (w.Value(value.*(f.member)), ...); }, fields);
+}
+
+template <typename T>
+std::string Encode(const T& value) {
+    std::string out;
+    out.reserve(64);
+    EncodeTo(out, value);
+    return out;
+}
+
+// 형식이 맞지 않으면 DecodeError
+template <typename T>
+T Decode(std::string_view data) {
+    constexpr auto fields = Schema<T>::fields();
+    Reader r(data);
+    if (r.Byte() != kMagic) throw DecodeError("codec: bad magic");
+    if (r.Byte() != Schema<T>::version) throw DecodeError("codec: schema version mismatch");
+    auto count = r.Varint();
+
+    T value{};
+    std::uint64_t i = 0;
+    std::apply([&](const auto&... f) {
+        ((i++ < count ? r.Value(value.*(f.member)) : void()), ...);
+    }, fields);
+    return value;
+}
+
+template <typename T>
+bool TryDecode(std::string_view data, T& out) {
+    try {
+        out = Decode<T>(data);
+        return true;
+    } catch (const DecodeError&) {
+        return false;
+    }
+}
+
+} // namespace codec
+} // namespace cache
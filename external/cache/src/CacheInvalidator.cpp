@@ -0,0 +1,42 @@
+#include "CacheInvalidator.h"
+
+namespace cache {
+
+CacheInvalidator::CacheInvalidator(RedisClient& redis, const RedisConfig& cfg,
+                                   std::string channel)
+    : redis_(redis), channel_(std::move(channel)),
+      subscriber_(cfg, [this](std::string, std::string key) { Dispatch(key); }) {}
+
+CacheInvalidator::~CacheInvalidator() {
+    Stop();
+}
+
+void CacheInvalidator::Register(std::string prefix, Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handlers_.emplace_back(std::move(prefix), std::move(handler));
+}
+
+void CacheInvalidator::Start() {
+    subscriber_.Subscribe(channel_);
+    subscriber_.Start();
+}
+
+void CacheInvalidator::Stop() {
+    subscriber_.Stop();
+}
+
+void CacheInvalidator::Publish(const std::string& key) {
+    Dispatch(key);
+    // 실패해도 다른 노드는 TTL 로 결국 맞춰진다
+    redis_.Publish(channel_, key);
+}
+
+void CacheInvalidator::Dispatch(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [prefix, handler] : handlers_) {
+        if (key.compare(0, prefix.size(), prefix) != 0) continue;
+        try { handler(key); } catch (...) {}
+    }
+}
+
+} // namespace cache
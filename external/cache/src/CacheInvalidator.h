@@ -0,0 +1,52 @@
+#pragma once
+#include "RedisClient.h"
+#include "RedisSubscriber.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// 노드 간 L1(NearCache) 무효화.
+// 값이 바뀐 노드가 Publish(key) 하면 로컬 핸들러를 바로 호출하고, 채널로 다른 노드에
+// 알린다. 각 노드는 key 의 prefix 로 등록된 핸들러(보통 NearCache::Invalidate)를 호출한다.
+// 자기 메시지도 다시 받지만 무효화는 여러 번 해도 같으므로 걸러내지 않는다.
+//
+//   CacheInvalidator inv(redis, cfg);
+//   inv.Register("user:", [&](const std::string& k) { users.Invalidate(k); });
+//   inv.Start();
+//   ... inv.Publish("user:" + name);
+class CacheInvalidator {
+public:
+    using Handler = std::function<void(const std::string& key)>;
+
+    CacheInvalidator(RedisClient& redis, const RedisConfig& cfg,
+                     std::string channel = "cache:invalidate");
+    ~CacheInvalidator();
+
+    CacheInvalidator(const CacheInvalidator&) = delete;
+    CacheInvalidator& operator=(const CacheInvalidator&) = delete;
+
+    void Register(std::string prefix, Handler handler);
+
+    void Start();
+    void Stop();
+
+    // 로컬 무효화 + 다른 노드에 전파 (Redis 호출이 있으므로 io 스레드에서 호출하지 말 것)
+    void Publish(const std::string& key);
+
+private:
+    void Dispatch(const std::string& key);
+
+    RedisClient& redis_;
+    std::string channel_;
+
+    std::mutex mutex_;
+    std::vector<std::pair<std::string, Handler>> handlers_;
+
+    RedisSubscriber subscriber_;
+};
+
+} // namespace cache
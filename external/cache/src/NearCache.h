@@ -0,0 +1,281 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// 프로세스 내 L1 캐시 (Redis 앞단).
+//  - 키 해시로 샤드를 나누고 샤드별 mutex + LRU, 항목 수/바이트 상한
+//  - TTL 만료, ttl * refresh_ahead 가 지난 항목은 조회 시 미리 다시 로드 (만료 전 갱신)
+//  - GetOrLoad: 같은 키의 동시 miss 는 로드 한 번으로 합친다 (single-flight)
+//  - Invalidate: 로컬 제거. 노드 간 전파는 CacheInvalidator 로
+//
+//   NearCache<User> users;
+//   auto u = users.GetOrLoad("user:" + name, [&] {
+//       return redis.GetOrLoad<User>(key, ttl, load_from_db);
+//   });
+template <typename T>
+class NearCache {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Loader = std::function<std::optional<T>()>;
+
+    struct Options {
+        std::size_t shards = 16;
+        std::size_t max_entries = 100000;
+        std::size_t max_bytes = 64 * 1024 * 1024;
+        std::chrono::milliseconds ttl{30000};
+        // ttl 의 이 비율이 지난 뒤 조회되면 미리 갱신 (0 이면 끔)
+        double refresh_ahead = 0.8;
+        // 항목 크기 추정 (비어 있으면 항목 구조체 크기 + key 길이)
+        std::function<std::size_t(const std::string&, const T&)> sizer;
+        // 미리 갱신을 실행할 곳 (비어 있으면 조회한 스레드에서 실행)
+        std::function<void(std::function<void()>)> refresher;
+    };
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t loads = 0;
+        std::uint64_t coalesced = 0;   // 다른 스레드의 로드를 기다린 miss
+        std::uint64_t refreshes = 0;
+        std::uint64_t evictions = 0;
+    };
+
+    NearCache() : NearCache(Options{}) {}
+    explicit NearCache(Options opts)
+        : opts_(std::move(opts)), shards_(opts_.shards > 0 ? opts_.shards : 1) {}
+
+    NearCache(const NearCache&) = delete;
+    NearCache& operator=(const NearCache&) = delete;
+
+    std::optional<T> Get(const std::string& key) {
+        auto& s = ShardFor(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.index.find(key);
+        if (it == s.index.end() || it->second->expires <= Clock::now()) {
+            stats_.misses++;
+            return std::nullopt;
+        }
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        stats_.hits++;
+        return it->second->value;
+    }
+
+    void Put(const std::string& key, T value) {
+        auto& s = ShardFor(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        Store(s, key, std::move(value));
+    }
+
+    // L1 hit 이면 바로, miss 면 loader() (같은 키의 동시 miss 는 한 번만 실행)
+    // loader 가 nullopt 를 반환하면 캐시하지 않는다. 미리 갱신에 쓰이므로 loader 는
+    // 호출이 끝난 뒤에도 유효한 것만 캡처해야 한다.
+    std::optional<T> GetOrLoad(const std::string& key, Loader loader) {
+        auto& s = ShardFor(key);
+        std::shared_future<std::optional<T>> wait;
+        std::shared_ptr<std::promise<std::optional<T>>> lead;
+        std::uint64_t epoch = 0;
+        {
+            std::unique_lock<std::mutex> lock(s.mutex);
+            auto now = Clock::now();
+            auto it = s.index.find(key);
+            if (it != s.index.end() && it->second->expires > now) {
+                s.lru.splice(s.lru.begin(), s.lru, it->second);
+                stats_.hits++;
+                auto& e = *it->second;
+                std::optional<T> value = e.value;
+                if (opts_.refresh_ahead > 0 && now >= e.refresh_at && !e.refreshing &&
+                    s.inflight.count(key) == 0) {
+                    e.refreshing = true;
+                    epoch = s.epoch;
+                    lock.unlock();
+                    Refresh(key, std::move(loader), epoch);
+                }
+                return value;
+            }
+            stats_.misses++;
+            auto f = s.inflight.find(key);
+            if (f != s.inflight.end()) {
+                stats_.coalesced++;
+                wait = f->second;
+            } else {
+                lead = std::make_shared<std::promise<std::optional<T>>>();
+                s.inflight.emplace(key, lead->get_future().share());
+                epoch = s.epoch;
+            }
+        }
+        if (!lead) return wait.get();
+
+        stats_.loads++;
+        std::optional<T> loaded;
+        try {
+            loaded = loader();
+        } catch (...) {
+            Finish(s, key, std::nullopt, epoch);
+            lead->set_exception(std::current_exception());
+            throw;
+        }
+        Finish(s, key, loaded, epoch);
+        lead->set_value(loaded);
+        return loaded;
+    }
+
+    void Invalidate(const std::string& key) {
+        auto& s = ShardFor(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        // 진행 중인 로드가 옛 값을 다시 넣지 않도록
+        s.epoch++;
+        auto it = s.index.find(key);
+        if (it == s.index.end()) return;
+        s.bytes -= it->second->bytes;
+        s.lru.erase(it->second);
+        s.index.erase(it);
+    }
+
+    void Clear() {
+        for (auto& s : shards_) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.epoch++;
+            s.lru.clear();
+            s.index.clear();
+            s.bytes = 0;
+        }
+    }
+
+    std::size_t Size() const {
+        std::size_t n = 0;
+        for (auto& s : shards_) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            n += s.index.size();
+        }
+        return n;
+    }
+
+    Stats GetStats() const {
+        Stats out;
+        out.hits = stats_.hits.load();
+        out.misses = stats_.misses.load();
+        out.loads = stats_.loads.load();
+        out.coalesced = stats_.coalesced.load();
+        out.refreshes = stats_.refreshes.load();
+        out.evictions = stats_.evictions.load();
+        return out;
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        T value;
+        Clock::time_point expires;
+        Clock::time_point refresh_at;
+        std::size_t bytes = 0;
+        bool refreshing = false;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru; // 앞쪽이 최근
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+        std::unordered_map<std::string, std::shared_future<std::optional<T>>> inflight;
+        std::size_t bytes = 0;
+        std::uint64_t epoch = 0; // Invalidate/Clear 마다 증가
+    };
+
+    struct AtomicStats {
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        std::atomic<std::uint64_t> loads{0};
+        std::atomic<std::uint64_t> coalesced{0};
+        std::atomic<std::uint64_t> refreshes{0};
+        std::atomic<std::uint64_t> evictions{0};
+    };
+
+    Shard& ShardFor(const std::string& key) {
+        return shards_[std::hash<std::string>{}(key) % shards_.size()];
+    }
+
+    std::size_t SizeOf(const std::string& key, const T& value) const {
+        return opts_.sizer ? opts_.sizer(key, value) : sizeof(Entry) + key.size();
+    }
+
+    // s.mutex 를 잡은 상태에서 호출
+    void Store(Shard& s, const std::string& key, T value) {
+        auto now = Clock::now();
+        auto it = s.index.find(key);
+        if (it != s.index.end()) {
+            s.bytes -= it->second->bytes;
+            s.lru.erase(it->second);
+            s.index.erase(it);
+        }
+        Entry e{key, std::move(value), now + opts_.ttl, now + opts_.ttl, 0, false};
+        if (opts_.refresh_ahead > 0 && opts_.refresh_ahead < 1) {
+            e.refresh_at = now + std::chrono::duration_cast<Clock::duration>(
+                                     opts_.ttl * opts_.refresh_ahead);
+        }
+        e.bytes = SizeOf(key, e.value);
+        s.bytes += e.bytes;
+        s.lru.push_front(std::move(e));
+        s.index.emplace(key, s.lru.begin());
+
+        std::size_t max_entries = std::max<std::size_t>(1, opts_.max_entries / shards_.size());
+        std::size_t max_bytes = std::max<std::size_t>(1, opts_.max_bytes / shards_.size());
+        while (s.lru.size() > 1 && (s.lru.size() > max_entries || s.bytes > max_bytes)) {
+            auto& victim = s.lru.back();
+            s.bytes -= victim.bytes;
+            s.index.erase(victim.key);
+            s.lru.pop_back();
+            stats_.evictions++;
+        }
+    }
+
+    // 로드 완료: 그 사이 무효화가 없었을 때만 저장
+    void Finish(Shard& s, const std::string& key, const std::optional<T>& loaded,
+                std::uint64_t epoch) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.inflight.erase(key);
+        if (loaded && s.epoch == epoch) Store(s, key, *loaded);
+    }
+
+    void Refresh(const std::string& key, Loader loader, std::uint64_t epoch) {
+        stats_.refreshes++;
+        auto job = [this, key, loader = std::move(loader), epoch] {
+            auto& s = ShardFor(key);
+            std::optional<T> loaded;
+            try {
+                loaded = loader();
+            } catch (...) {
+                // 실패하면 만료될 때까지 기존 값을 쓴다
+            }
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (s.epoch != epoch) return;
+            auto it = s.index.find(key);
+            if (loaded) {
+                Store(s, key, std::move(*loaded));
+            } else if (it != s.index.end()) {
+                it->second->refreshing = false;
+            }
+        };
+        if (opts_.refresher) opts_.refresher(std::move(job));
+        else job();
+    }
+
+    Options opts_;
+    std::vector<Shard> shards_;
+    AtomicStats stats_;
+};
+
+} // namespace cache
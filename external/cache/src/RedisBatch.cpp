@@ -0,0 +1,38 @@
+#include "RedisBatch.h"
+
+namespace cache {
+
+void RedisBatch::Fail(const std::vector<std::size_t>& indices, const std::string& error,
+                      std::vector<BatchReply>& out) {
+    for (auto i : indices) {
+        out[i].ok = false;
+        out[i].error = error;
+    }
+}
+
+static std::uint16_t crc16(const char* buf, std::size_t len) {
+    // CRC16/XMODEM (poly 0x1021), Redis Cluster 명세와 동일
+    std::uint16_t crc = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc ^= static_cast<std::uint16_t>(static_cast<unsigned char>(buf[i]) << 8);
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? static_cast<std::uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<std::uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+std::uint16_t KeySlot(const std::string& key) {
+    // {tag} 가 있고 비어 있지 않으면 tag 만 해시한다
+    auto open = key.find('{');
+    if (open != std::string::npos) {
+        auto close = key.find('}', open + 1);
+        if (close != std::string::npos && close > open + 1) {
+            return crc16(key.data() + open + 1, close - open - 1) & 16383;
+        }
+    }
+    return crc16(key.data(), key.size()) & 16383;
+}
+
+} // namespace cache
@@ -0,0 +1,195 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// 명령 하나의 결과. 명령 종류에 맞는 필드만 채워진다.
+//  - Set/LTrim/Expire            : ok
+//  - Del/LPush/RPush/HSet/HDel/HIncrBy/ZAdd/ZRem/Publish/Incr : integer
+//  - Get/HGet                    : str (없으면 nullopt)
+//  - LRange                      : list
+// ok == false 면 error 에 사유 (명령 오류 또는 전송 실패)
+struct BatchReply {
+    bool ok = false;
+    long long integer = 0;
+    std::optional<std::string> str;
+    std::vector<std::string> list;
+    std::string error;
+};
+
+// 여러 명령을 모아 한 번의 왕복으로 보내는 빌더.
+// 각 메서드는 결과 벡터에서의 인덱스를 반환한다.
+//   RedisBatch b;
+//   auto i = b.LPush(key, v); b.LTrim(key, 0, 99);
+//   auto replies = client.Exec(b);   // 또는 ExecTransaction(b) (MULTI/EXEC)
+//   replies[i].integer
+class RedisBatch {
+public:
+    enum class Kind {
+        Set, Get, Del, Expire, Incr,
+        LPush, RPush, LTrim, LRange,
+        HSet, HGet, HDel, HIncrBy,
+        ZAdd, ZRem,
+        Publish,
+    };
+
+    struct Op {
+        Kind kind;
+        std::string key;
+        std::string a;       // value / field / member / message
+        std::string b;       // hash value
+        long long n1 = 0;    // start / increment / ttl(ms)
+        long long n2 = 0;    // stop
+        double score = 0.0;
+    };
+
+    std::size_t Set(std::string key, std::string value,
+                    std::optional<std::chrono::seconds> ttl = std::nullopt) {
+        return Add({Kind::Set, std::move(key), std::move(value), {},
+                    ttl ? std::chrono::duration_cast<std::chrono::milliseconds>(*ttl).count() : 0});
+    }
+    std::size_t Get(std::string key) { return Add({Kind::Get, std::move(key)}); }
+    std::size_t Del(std::string key) { return Add({Kind::Del, std::move(key)}); }
+    std::size_t Expire(std::string key, std::chrono::seconds ttl) {
+        return Add({Kind::Expire, std::move(key), {}, {}, ttl.count()});
+    }
+    std::size_t Incr(std::string key, long long by = 1) {
+        return Add({Kind::Incr, std::move(key), {}, {}, by});
+    }
+
+    std::size_t LPush(std::string key, std::string value) {
+        return Add({Kind::LPush, std::move(key), std::move(value)});
+    }
+    std::size_t RPush(std::string key, std::string value) {
+        return Add({Kind::RPush, std::move(key), std::move(value)});
+    }
+    std::size_t LTrim(std::string key, long long start, long long stop) {
+        return Add({Kind::LTrim, std::move(key), {}, {}, start, stop});
+    }
+    std::size_t LRange(std::string key, long long start, long long stop) {
+        return Add({Kind::LRange, std::move(key), {}, {}, start, stop});
+    }
+
+    std::size_t HSet(std::string key, std::string field, std::string value) {
+        return Add({Kind::HSet, std::move(key), std::move(field), std::move(value)});
+    }
+    std::size_t HGet(std::string key, std::string field) {
+        return Add({Kind::HGet, std::move(key), std::move(field)});
+    }
+    std::size_t HDel(std::string key, std::string field) {
+        return Add({Kind::HDel, std::move(key), std::move(field)});
+    }
+    std::size_t HIncrBy(std::string key, std::string field, long long increment) {
+        return Add({Kind::HIncrBy, std::move(key), std::move(field), {}, increment});
+    }
+
+    std::size_t ZAdd(std::string key, std::string member, double score) {
+        Op op{Kind::ZAdd, std::move(key), std::move(member)};
+        op.score = score;
+        return Add(std::move(op));
+    }
+    std::size_t ZRem(std::string key, std::string member) {
+        return Add({Kind::ZRem, std::move(key), std::move(member)});
+    }
+
+    // 클러스터에서는 채널 이름으로 노드를 고른다
+    std::size_t Publish(std::string channel, std::string message) {
+        return Add({Kind::Publish, std::move(channel), std::move(message)});
+    }
+
+    const std::vector<Op>& Ops() const { return ops_; }
+    std::size_t Size() const { return ops_.size(); }
+    bool Empty() const { return ops_.empty(); }
+    void Clear() { ops_.clear(); }
+
+    // ---- 파이프라인 실행 도우미 (RedisClient / RedisClusterClient 공용) ----
+    // q 는 sw::redis::Pipeline / Transaction
+    template <typename Queued>
+    static void Queue(Queued& q, const Op& op);
+    // exec() 결과를 out[indices[i]] 에 채운다
+    template <typename Replies>
+    static void Parse(Replies& replies, const std::vector<Op>& ops,
+                      const std::vector<std::size_t>& indices, std::vector<BatchReply>& out);
+    static void Fail(const std::vector<std::size_t>& indices, const std::string& error,
+                     std::vector<BatchReply>& out);
+
+private:
+    std::size_t Add(Op op) {
+        ops_.push_back(std::move(op));
+        return ops_.size() - 1;
+    }
+
+    std::vector<Op> ops_;
+};
+
+// Redis Cluster 해시 슬롯 (CRC16/XMODEM mod 16384, {hash tag} 지원)
+std::uint16_t KeySlot(const std::string& key);
+
+template <typename Queued>
+void RedisBatch::Queue(Queued& q, const Op& op) {
+    switch (op.kind) {
+    case Kind::Set:
+        if (op.n1 > 0) q.set(op.key, op.a, std::chrono::milliseconds(op.n1));
+        else q.set(op.key, op.a);
+        break;
+    case Kind::Get: q.get(op.key); break;
+    case Kind::Del: q.del(op.key); break;
+    case Kind::Expire: q.expire(op.key, std::chrono::seconds(op.n1)); break;
+    case Kind::Incr: q.incrby(op.key, op.n1); break;
+    case Kind::LPush: q.lpush(op.key, op.a); break;
+    case Kind::RPush: q.rpush(op.key, op.a); break;
+    case Kind::LTrim: q.ltrim(op.key, op.n1, op.n2); break;
+    case Kind::LRange: q.lrange(op.key, op.n1, op.n2); break;
+    case Kind::HSet: q.hset(op.key, op.a, op.b); break;
+    case Kind::HGet: q.hget(op.key, op.a); break;
+    case Kind::HDel: q.hdel(op.key, op.a); break;
+    case Kind::HIncrBy: q.hincrby(op.key, op.a, op.n1); break;
+    case Kind::ZAdd: q.zadd(op.key, op.a, op.score); break;
+    case Kind::ZRem: q.zrem(op.key, op.a); break;
+    case Kind::Publish: q.publish(op.key, op.a); break;
+    }
+}
+
+template <typename Replies>
+void RedisBatch::Parse(Replies& replies, const std::vector<Op>& ops,
+                       const std::vector<std::size_t>& indices, std::vector<BatchReply>& out) {
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        auto& r = out[indices[i]];
+        try {
+            switch (ops[indices[i]].kind) {
+            case Kind::Set:
+            case Kind::LTrim:
+            case Kind::Expire:
+                r.ok = replies.template get<bool>(i);
+                if (!r.ok) r.error = "not applied";
+                continue;
+            case Kind::Get:
+            case Kind::HGet: {
+                auto v = replies.template get<std::optional<std::string>>(i);
+                if (v) r.str = std::move(*v);
+                break;
+            }
+            case Kind::LRange:
+                replies.get(i, std::back_inserter(r.list));
+                break;
+            default:
+                r.integer = replies.template get<long long>(i);
+                break;
+            }
+            r.ok = true;
+        } catch (const std::exception& e) {
+            r.ok = false;
+            r.error = e.what();
+        }
+    }
+}
+
+} // namespace cache
@@ -1,4 +1,8 @@
 #include "RedisClient.h"
+#include <algorithm>
+#include <future>
+#include <map>
+#include <numeric>
 #include <random>
 
 namespace cache {
@@ -82,6 +86,52 @@ void RedisClient::Del(const std::string& key) {
     try { redis_.del(key); } catch (...) {}
 }
 
+bool RedisClient::Expire(const std::string& key, std::chrono::seconds ttl) {
+    try { return redis_.expire(key, ttl); } catch (...) { return false; }
+}
+
+// indices 의 명령을 q 에 쌓아 exec() 한 번으로 보내고 out 에 결과를 채운다
+template <typename Queued>
+static void run_queued(Queued&& q, const RedisBatch& batch,
+                       const std::vector<std::size_t>& indices, std::vector<BatchReply>& out) {
+    try {
+        for (auto i : indices) RedisBatch::Queue(q, batch.Ops()[i]);
+        auto replies = q.exec();
+        RedisBatch::Parse(replies, batch.Ops(), indices, out);
+    } catch (const std::exception& e) {
+        RedisBatch::Fail(indices, e.what(), out);
+    }
+}
+
+static std::vector<std::size_t> all_indices(const RedisBatch& batch) {
+    std::vector<std::size_t> indices(batch.Size());
+    std::iota(indices.begin(), indices.end(), 0);
+    return indices;
+}
+
+std::vector<BatchReply> RedisClient::Exec(const RedisBatch& batch) {
+    std::vector<BatchReply> out(batch.Size());
+    if (batch.Empty()) return out;
+    try {
+        // 풀 커넥션을 빌려 쓴다 (새 커넥션 생성 없음)
+        run_queued(redis_.pipeline(false), batch, all_indices(batch), out);
+    } catch (const std::exception& e) {
+        RedisBatch::Fail(all_indices(batch), e.what(), out);
+    }
+    return out;
+}
+
+std::vector<BatchReply> RedisClient::ExecTransaction(const RedisBatch& batch) {
+    std::vector<BatchReply> out(batch.Size());
+    if (batch.Empty()) return out;
+    try {
+        run_queued(redis_.transaction(false, false), batch, all_indices(batch), out);
+    } catch (const std::exception& e) {
+        RedisBatch::Fail(all_indices(batch), e.what(), out);
+    }
+    return out;
+}
+
 bool RedisClient::AcquireLock(const std::string& lockKey, std::chrono::seconds ttl) {
     try {
         // SET key "1" NX EX ttl
@@ -107,15 +157,50 @@ std::optional<std::chrono::seconds> RedisClient::jitteredTTL(
     return std::chrono::seconds{s};
 }
 
-RedisClusterClient::RedisClusterClient(const RedisClusterConfig& cfg) {
+// "tcp://a:7000, b:7001" → {"tcp://a:7000", "tcp://b:7001"}
+static std::vector<std::string> split_nodes(const std::string& nodes) {
+    std::vector<std::string> out;
+    std::size_t pos = 0;
+    while (pos <= nodes.size()) {
+        auto end = nodes.find(',', pos);
+        if (end == std::string::npos) end = nodes.size();
+        auto first = nodes.find_first_not_of(' ', pos);
+        auto last = nodes.find_last_not_of(' ', end - 1);
+        if (first != std::string::npos && first < end && last >= first) {
+            auto node = nodes.substr(first, last - first + 1);
+            if (node.find("://") == std::string::npos) node = "tcp://" + node;
+            out.push_back(std::move(node));
+        }
+        pos = end + 1;
+    }
+    return out;
+}
+
+RedisClusterClient::RedisClusterClient(const RedisClusterConfig& cfg)
+    : max_parallel_(std::max<std::size_t>(1, cfg.max_parallel)) {
     using namespace sw::redis;
 
-    ConnectionOptions opts;
-    opts.socket_timeout = cfg.socket_timeout;
-    if (!cfg.password.empty()) opts.password = cfg.password;
+    ConnectionPoolOptions popts;
+    popts.size = cfg.pool_size;
+    popts.wait_timeout = cfg.pool_wait;
+    popts.connection_lifetime = cfg.connection_lifetime;
 
-    // cluster 노드 목록 지정
-    cluster_ = std::make_unique<RedisCluster>(cfg.nodes);
+    // 시드 노드 중 처음 연결되는 곳에서 슬롯 맵을 받는다
+    std::string last_error = "no seed nodes";
+    for (auto& node : split_nodes(cfg.nodes)) {
+        ConnectionOptions opts(node);
+        opts.socket_timeout = cfg.socket_timeout;
+        opts.connect_timeout = cfg.connect_timeout;
+        if (!cfg.user.empty()) opts.user = cfg.user;
+        if (!cfg.password.empty()) opts.password = cfg.password;
+        try {
+            cluster_ = std::make_unique<RedisCluster>(opts, popts);
+            return;
+        } catch (const std::exception& e) {
+            last_error = node + ": " + e.what();
+        }
+    }
+    throw std::runtime_error("redis cluster: no reachable seed node (" + last_error + ")");
 }
 
 bool RedisClusterClient::Set(const std::string& key, const std::string& value,
@@ -143,4 +228,279 @@ void RedisClusterClient::Del(const std::string& key) {
     try { cluster_->del(key); } catch (...) {}
 }
 
-} // namespace cache
\ No newline at end of file
+bool RedisClusterClient::Expire(const std::string& key, std::chrono::seconds ttl) {
+    try { return cluster_->expire(key, ttl); } catch (...) { return false; }
+}
+
+std::vector<BatchReply> RedisClusterClient::Exec(const RedisBatch& batch) {
+    std::vector<BatchReply> out(batch.Size());
+    if (batch.Empty()) return out;
+
+    auto slots = CurrentSlots();
+    std::map<long, std::vector<std::size_t>> by_node;
+    for (std::size_t i = 0; i < batch.Size(); ++i) {
+        by_node[NodeOf(slots.get(), KeySlot(batch.Ops()[i].key))].push_back(i);
+    }
+    std::vector<const std::vector<std::size_t>*> groups;
+    groups.reserve(by_node.size());
+    for (auto& [node, indices] : by_node) groups.push_back(&indices);
+
+    // 그룹마다 out 의 서로 다른 인덱스만 쓰므로 락이 필요 없다.
+    // 파이프라인은 첫 키의 슬롯 담당 노드로 가고, 같은 노드의 다른 슬롯도 처리된다
+    auto run = [this, &batch, &out](const std::vector<std::size_t>& indices) {
+        try {
+            run_queued(cluster_->pipeline(batch.Ops()[indices.front()].key, false), batch,
+                       indices, out);
+        } catch (const std::exception& e) {
+            RedisBatch::Fail(indices, e.what(), out);
+        }
+    };
+    RunParallel(groups.size(), [&](std::size_t g) { run(*groups[g]); });
+
+    // 슬롯이 옮겨져 MOVED/ASK 로 거절된 명령만 맵을 갱신하게 하고 슬롯별로 다시
+    std::map<std::uint16_t, std::vector<std::size_t>> moved;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        auto& e = out[i].error;
+        if (!out[i].ok && (e.rfind("MOVED", 0) == 0 || e.rfind("ASK", 0) == 0))
+            moved[KeySlot(batch.Ops()[i].key)].push_back(i);
+    }
+    if (!moved.empty()) {
+        slots_stale_ = true;
+        for (auto& [slot, indices] : moved) run(indices);
+    }
+    return out;
+}
+
+long RedisClusterClient::NodeOf(const SlotMap* slots, std::uint16_t slot) {
+    return slots && slots->owner[slot] >= 0 ? slots->owner[slot] : -1L - slot;
+}
+
+void RedisClusterClient::RunParallel(std::size_t count,
+                                     const std::function<void(std::size_t)>& task) {
+    std::size_t threads = std::min(count, max_parallel_);
+    if (threads <= 1) {
+        for (std::size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+    // 작업 큐 대신 다음 인덱스를 나눠 가진다
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (std::size_t i; (i = next.fetch_add(1)) < count;) task(i);
+    };
+    std::vector<std::future<void>> pending;
+    pending.reserve(threads - 1);
+    for (std::size_t t = 1; t < threads; ++t) {
+        pending.push_back(std::async(std::launch::async, worker));
+    }
+    worker();
+    for (auto& f : pending) f.get();
+}
+
+std::vector<BatchReply> RedisClusterClient::ExecTransaction(const RedisBatch& batch) {
+    std::vector<BatchReply> out(batch.Size());
+    if (batch.Empty()) return out;
+
+    auto indices = all_indices(batch);
+    auto slot = KeySlot(batch.Ops().front().key);
+    for (auto& op : batch.Ops()) {
+        if (KeySlot(op.key) != slot) {
+            RedisBatch::Fail(indices, "CROSSSLOT keys in transaction", out);
+            return out;
+        }
+    }
+    try {
+        run_queued(cluster_->transaction(batch.Ops().front().key, false, false), batch,
+                   indices, out);
+    } catch (const std::exception& e) {
+        RedisBatch::Fail(indices, e.what(), out);
+    }
+    return out;
+}
+
+std::shared_ptr<const RedisClusterClient::SlotMap> RedisClusterClient::CurrentSlots() {
+    std::lock_guard<std::mutex> lock(slots_mutex_);
+    if (slots_stale_.exchange(false)) {
+        if (auto fresh = LoadSlots()) slots_ = std::move(fresh);
+    }
+    return slots_;
+}
+
+// CLUSTER SLOTS: [[start, end, [host, port, id...], replicas...], ...]
+std::shared_ptr<const RedisClusterClient::SlotMap> RedisClusterClient::LoadSlots() {
+    try {
+        auto reply = cluster_->command("CLUSTER", "SLOTS");
+        if (!reply || reply->type != REDIS_REPLY_ARRAY) return nullptr;
+
+        auto map = std::make_shared<SlotMap>();
+        map->owner.assign(16384, -1);
+        for (std::size_t i = 0; i < reply->elements; ++i) {
+            auto* range = reply->element[i];
+            if (range->type != REDIS_REPLY_ARRAY || range->elements < 3) continue;
+            auto* master = range->element[2];
+            if (master->type != REDIS_REPLY_ARRAY || master->elements < 2) continue;
+
+            auto node = std::string(master->element[0]->str, master->element[0]->len) + ":" +
+                        std::to_string(master->element[1]->integer);
+            auto it = std::find(map->nodes.begin(), map->nodes.end(), node);
+            int index = static_cast<int>(it - map->nodes.begin());
+            if (it == map->nodes.end()) map->nodes.push_back(node);
+
+            auto first = std::max<long long>(range->element[0]->integer, 0);
+            auto last = std::min<long long>(range->element[1]->integer, 16383);
+            for (auto slot = first; slot <= last; ++slot) map->owner[slot] = index;
+        }
+        return map;
+    } catch (...) {
+        // 슬롯 맵 없이도 동작한다 (슬롯별로 보냄)
+        return nullptr;
+    }
+}
+
+std::vector<RedisClusterClient::KeyGroup> RedisClusterClient::GroupBySlot(
+    const std::vector<std::string>& keys) {
+    std::map<std::uint16_t, KeyGroup> by_slot;
+    for (std::size_t i = 0; i < keys.size(); ++i) by_slot[KeySlot(keys[i])].push_back(i);
+
+    std::vector<KeyGroup> groups;
+    groups.reserve(by_slot.size());
+    for (auto& [slot, indices] : by_slot) groups.push_back(std::move(indices));
+    return groups;
+}
+
+bool RedisClusterClient::RunGroups(const std::vector<std::string>& keys,
+                                   const std::vector<KeyGroup>& groups,
+                                   const GroupQueue& queue, const GroupParse& parse) {
+    if (groups.empty()) return true;
+
+    // 노드별로 묶는다. 슬롯 맵을 모르는 슬롯은 따로 (음수 키)
+    auto slots = CurrentSlots();
+    std::map<long, std::vector<std::size_t>> by_node;
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        by_node[NodeOf(slots.get(), KeySlot(keys[groups[g].front()]))].push_back(g);
+    }
+    std::vector<const std::vector<std::size_t>*> tasks;
+    tasks.reserve(by_node.size());
+    for (auto& [node, gs] : by_node) tasks.push_back(&gs);
+
+    // 태스크마다 failed 의 서로 다른 인덱스만 쓴다
+    std::vector<char> failed(groups.size(), 0);
+    auto run = [this, &keys, &groups, &queue, &parse,
+                &failed](const std::vector<std::size_t>& gs) {
+        try {
+            auto pipe = cluster_->pipeline(keys[groups[gs.front()].front()], false);
+            for (auto g : gs) queue(pipe, groups[g]);
+            auto replies = pipe.exec();
+            for (std::size_t i = 0; i < gs.size(); ++i) {
+                try { parse(replies, i, groups[gs[i]]); } catch (...) { failed[gs[i]] = 1; }
+            }
+        } catch (...) {
+            for (auto g : gs) failed[g] = 1;
+        }
+    };
+
+    // 슬롯 맵이 없으면 슬롯마다 한 묶음이 되므로 스레드 수는 max_parallel 로 묶는다
+    RunParallel(tasks.size(), [&](std::size_t t) { run(*tasks[t]); });
+
+    // MOVED/ASK 등: 슬롯 맵을 다시 받게 하고 실패한 묶음만 슬롯 단위로 한 번 더
+    bool ok = true;
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        if (!failed[g]) continue;
+        slots_stale_ = true;
+        try {
+            auto pipe = cluster_->pipeline(keys[groups[g].front()], false);
+            queue(pipe, groups[g]);
+            auto replies = pipe.exec();
+            parse(replies, 0, groups[g]);
+        } catch (...) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+std::vector<std::optional<std::string>> RedisClusterClient::MGet(
+    const std::vector<std::string>& keys) {
+    std::vector<std::optional<std::string>> out(keys.size());
+    auto select = [&keys](const KeyGroup& group) {
+        std::vector<std::string> ks;
+        ks.reserve(group.size());
+        for (auto i : group) ks.push_back(keys[i]);
+        return ks;
+    };
+    RunGroups(
+        keys, GroupBySlot(keys),
+        [&select](sw::redis::Pipeline& pipe, const KeyGroup& group) {
+            auto ks = select(group);
+            pipe.mget(ks.begin(), ks.end());
+        },
+        [&out](sw::redis::QueuedReplies& replies, std::size_t i, const KeyGroup& group) {
+            std::vector<sw::redis::OptionalString> values;
+            replies.get(i, std::back_inserter(values));
+            for (std::size_t j = 0; j < group.size() && j < values.size(); ++j) {
+                if (values[j]) out[group[j]] = std::move(*values[j]);
+            }
+        });
+    return out;
+}
+
+bool RedisClusterClient::MSet(const std::vector<std::pair<std::string, std::string>>& kvs) {
+    std::vector<std::string> keys;
+    keys.reserve(kvs.size());
+    for (auto& kv : kvs) keys.push_back(kv.first);
+    return RunGroups(
+        keys, GroupBySlot(keys),
+        [&kvs](sw::redis::Pipeline& pipe, const KeyGroup& group) {
+            std::vector<std::pair<std::string, std::string>> part;
+            part.reserve(group.size());
+            for (auto i : group) part.push_back(kvs[i]);
+            pipe.mset(part.begin(), part.end());
+        },
+        [](sw::redis::QueuedReplies& replies, std::size_t i, const KeyGroup&) {
+            if (!replies.get<bool>(i)) throw std::runtime_error("MSET not applied");
+        });
+}
+
+long long RedisClusterClient::Del(const std::vector<std::string>& keys) {
+    auto groups = GroupBySlot(keys);
+    // 묶음별 삭제 수 (태스크마다 다른 칸)
+    std::vector<long long> counts(keys.size(), 0);
+    RunGroups(
+        keys, groups,
+        [&keys](sw::redis::Pipeline& pipe, const KeyGroup& group) {
+            std::vector<std::string> ks;
+            ks.reserve(group.size());
+            for (auto i : group) ks.push_back(keys[i]);
+            pipe.del(ks.begin(), ks.end());
+        },
+        [&counts](sw::redis::QueuedReplies& replies, std::size_t i, const KeyGroup& group) {
+            counts[group.front()] = replies.get<long long>(i);
+        });
+    return std::accumulate(counts.begin(), counts.end(), 0LL);
+}
+
+std::vector<std::vector<std::optional<std::string>>> RedisClusterClient::HMGet(
+    const std::vector<std::string>& keys, const std::vector<std::string>& fields) {
+    std::vector<std::vector<std::optional<std::string>>> out(
+        keys.size(), std::vector<std::optional<std::string>>(fields.size()));
+    if (fields.empty()) return out;
+
+    // HMGET 은 키 하나짜리 명령이므로 키마다 묶음 하나 (노드별 파이프라인으로 합쳐진다)
+    std::vector<KeyGroup> groups(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) groups[i] = {i};
+    RunGroups(
+        keys, groups,
+        [&keys, &fields](sw::redis::Pipeline& pipe, const KeyGroup& group) {
+            pipe.hmget(keys[group.front()], fields.begin(), fields.end());
+        },
+        [&out](sw::redis::QueuedReplies& replies, std::size_t i, const KeyGroup& group) {
+            std::vector<sw::redis::OptionalString> values;
+            replies.get(i, std::back_inserter(values));
+            auto& row = out[group.front()];
+            for (std::size_t j = 0; j < row.size() && j < values.size(); ++j) {
+                if (values[j]) row[j] = std::move(*values[j]);
+            }
+        });
+    return out;
+}
+
+} // namespace cache
@@ -1,5 +1,10 @@
 #pragma once
 #include <sw/redis++/redis++.h>
+#include "BinaryCodec.h"
+#include "RedisBatch.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <chrono>
@@ -38,6 +43,7 @@ public:
              std::optional<std::chrono::seconds> ttl = std::nullopt);
     std::optional<std::string> Get(const std::string& key);
     void Del(const std::string& key);
+    bool Expire(const std::string& key, std::chrono::seconds ttl);
 
     // 캐시-어사이드: miss면 loader()로 로드 후 캐시에 set
     template <typename T, typename Loader, typename Encoder, typename Decoder>
@@ -90,6 +96,40 @@ public:
         return true;
     }
 
+    // 바이너리 코덱 버전 (codec::Schema<T> 특수화 필요, 예: db/ModelCodec.h)
+    template <typename T, typename Loader>
+    std::optional<T> GetOrLoad(
+        const std::string& key,
+        std::chrono::seconds ttl_base,
+        Loader&& loader,   // () -> std::optional<T>
+        std::optional<std::chrono::seconds> ttl_jitter = std::nullopt
+    ) {
+        auto v = Get(key);
+        if (v) {
+            T value;
+            if (codec::TryDecode(*v, value)) return value;
+            // 옛 포맷/스키마: 지우고 다시 로드
+            Del(key);
+        }
+
+        auto loaded = loader();
+        if (!loaded) return std::nullopt;
+        Set(key, codec::Encode(*loaded), jitteredTTL(ttl_base, ttl_jitter));
+        return loaded;
+    }
+
+    template <typename T, typename Writer>
+    bool WriteThrough(
+        const std::string& key,
+        const T& value,
+        Writer&& writer,   // (const T&) -> bool
+        std::chrono::seconds ttl = std::chrono::seconds(600)
+    ) {
+        if (!writer(value)) return false;
+        Set(key, codec::Encode(value), ttl);
+        return true;
+    }
+
     // -----------------------------
     // List APIs
     // -----------------------------
@@ -289,6 +329,24 @@ public:
         } catch (...) { return {}; }
     }
 
+    // -----------------------------
+    // Pipeline / Transaction
+    // -----------------------------
+    // batch 의 명령을 한 번의 왕복으로 보낸다. 결과는 batch 인덱스 순서.
+    // 명령별로 성공/실패가 따로 채워지고, 전송 자체가 실패하면 전부 실패.
+    std::vector<BatchReply> Exec(const RedisBatch& batch);
+    // MULTI/EXEC 로 원자적으로 실행
+    std::vector<BatchReply> ExecTransaction(const RedisBatch& batch);
+
+    // -----------------------------
+    // Pub/Sub APIs
+    // -----------------------------
+    // 메시지를 받은 구독자 수, 실패 시 -1
+    long long Publish(const std::string& channel, const std::string& message) {
+        try { return redis_.publish(channel, message); } catch (...) { return -1; }
+    }
+    // 구독은 전용 커넥션/스레드가 필요하므로 RedisSubscriber 를 쓴다
+
     // 분산락 (간단 버전)
     bool AcquireLock(const std::string& lockKey, std::chrono::seconds ttl);
     void ReleaseLock(const std::string& lockKey);
@@ -303,10 +361,19 @@ private:
 };
 
 struct RedisClusterConfig {
-    // 콤마로 구분된 노드 주소들 "tcp://127.0.0.1:7000,127.0.0.1:7001";
+    // 콤마로 구분된 시드 노드 주소들 "tcp://127.0.0.1:7000,127.0.0.1:7001".
+    // 처음 연결되는 노드에서 나머지 토폴로지를 받아온다.
     std::string nodes = "tcp://127.0.0.1:7000";
     std::chrono::milliseconds socket_timeout{200};
+    std::chrono::milliseconds connect_timeout{200};
+    std::string user;       // ACL 사용자 (비어 있으면 default)
     std::string password;
+    // 노드별 커넥션 풀
+    std::size_t pool_size = 6;
+    std::chrono::milliseconds pool_wait{100};
+    std::chrono::minutes connection_lifetime{10};
+    // Exec/멀티 키 명령이 동시에 보내는 파이프라인 수 상한 (호출 스레드 포함)
+    std::size_t max_parallel = 4;
 };
 
 class RedisClusterClient {
@@ -317,6 +384,7 @@ public:
              std::optional<std::chrono::seconds> ttl = std::nullopt);
     std::optional<std::string> Get(const std::string& key);
     void Del(const std::string& key);
+    bool Expire(const std::string& key, std::chrono::seconds ttl);
 
     bool LPush(const std::string& key, const std::string& value) {
         try { cluster_->lpush(key, value); return true; } catch (...) { return false; }
@@ -476,9 +544,65 @@ public:
         } catch (...) { return {}; }
     }
 
+    long long Publish(const std::string& channel, const std::string& message) {
+        try { return cluster_->publish(channel, message); } catch (...) { return -1; }
+    }
+
+    // -----------------------------
+    // Multi-key APIs (Cluster)
+    // 키를 슬롯별 명령으로 나누고, 같은 노드의 명령은 파이프라인 하나로 묶어
+    // 노드들에 병렬로 보낸다. 결과는 입력 순서. 토폴로지가 바뀌어 실패한 부분은
+    // 슬롯 맵을 갱신하고 한 번 더 보낸다.
+    // -----------------------------
+    // 실패한 키는 nullopt
+    std::vector<std::optional<std::string>> MGet(const std::vector<std::string>& keys);
+    // 모두 성공해야 true (부분 실패 가능, 슬롯 간 원자성 없음)
+    bool MSet(const std::vector<std::pair<std::string, std::string>>& kvs);
+    // 삭제된 키 수
+    long long Del(const std::vector<std::string>& keys);
+    // 키마다 HMGET key fields... → out[i][j] = keys[i] 의 fields[j]
+    std::vector<std::vector<std::optional<std::string>>> HMGet(
+        const std::vector<std::string>& keys, const std::vector<std::string>& fields);
+
+    // CLUSTER SLOTS 맵으로 키를 담당 노드별로 묶어 노드마다 파이프라인 1개,
+    // 여러 노드면 최대 max_parallel 개씩 병렬로 보낸다. 맵이 오래돼 MOVED/ASK 로
+    // 실패한 명령만 슬롯별로 다시 보낸다. 결과는 batch 인덱스 순서.
+    std::vector<BatchReply> Exec(const RedisBatch& batch);
+    // MULTI/EXEC 는 한 슬롯 안에서만 가능. 여러 슬롯에 걸치면 전부 CROSSSLOT 실패
+    // ({hash tag} 로 키를 같은 슬롯에 모을 것)
+    std::vector<BatchReply> ExecTransaction(const RedisBatch& batch);
 
 private:
+    // 명령 하나가 다루는 키 인덱스 묶음 (모두 같은 슬롯)
+    using KeyGroup = std::vector<std::size_t>;
+    using GroupQueue = std::function<void(sw::redis::Pipeline&, const KeyGroup&)>;
+    // (replies, 응답 인덱스, 묶음). 실패면 예외
+    using GroupParse =
+        std::function<void(sw::redis::QueuedReplies&, std::size_t, const KeyGroup&)>;
+
+    // CLUSTER SLOTS 결과: 슬롯 → 노드 번호
+    struct SlotMap {
+        std::vector<std::string> nodes;   // "host:port"
+        std::vector<int> owner;           // 16384 개, 모르면 -1
+    };
+
+    std::shared_ptr<const SlotMap> CurrentSlots();
+    std::shared_ptr<const SlotMap> LoadSlots();
+    // 노드 키: 슬롯 맵이 있으면 노드 번호, 없거나 모르는 슬롯이면 -1 - slot
+    static long NodeOf(const SlotMap* slots, std::uint16_t slot);
+    // task(0..count-1) 를 최대 max_parallel_ 개 스레드로 (호출 스레드 포함) 실행
+    void RunParallel(std::size_t count, const std::function<void(std::size_t)>& task);
+    static std::vector<KeyGroup> GroupBySlot(const std::vector<std::string>& keys);
+    // groups 를 노드별 파이프라인으로 실행 (최대 max_parallel 개 동시). 모두 성공하면 true
+    bool RunGroups(const std::vector<std::string>& keys, const std::vector<KeyGroup>& groups,
+                   const GroupQueue& queue, const GroupParse& parse);
+
     std::unique_ptr<sw::redis::RedisCluster> cluster_;
+    std::size_t max_parallel_;
+
+    std::mutex slots_mutex_;
+    std::shared_ptr<const SlotMap> slots_;
+    std::atomic<bool> slots_stale_{true};
 };
 
 } // namespace cache
\ No newline at end of file
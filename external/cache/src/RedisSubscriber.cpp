@@ -0,0 +1,99 @@
+#include "RedisSubscriber.h"
+
+namespace cache {
+
+// 구독 커넥션은 consume() 이 주기적으로 깨어나야 하므로 소켓 타임아웃을 반드시 건다
+static sw::redis::Redis make_subscriber_redis(const RedisConfig& cfg) {
+    using namespace sw::redis;
+
+    ConnectionOptions opts;
+    if (!cfg.host.empty() && cfg.port > 0) {
+        opts.host = cfg.host;
+        opts.port = cfg.port;
+    } else if (!cfg.url.empty()) {
+        opts = ConnectionOptions(cfg.url);
+    }
+    if (!cfg.password.empty()) opts.password = cfg.password;
+    if (cfg.db >= 0) opts.db = cfg.db;
+    opts.socket_timeout = cfg.socket_timeout.count() > 0 ? cfg.socket_timeout
+                                                         : std::chrono::milliseconds(200);
+
+    // 구독은 커넥션 하나만 쓴다
+    ConnectionPoolOptions popts;
+    popts.size = 1;
+    return Redis(opts, popts);
+}
+
+RedisSubscriber::RedisSubscriber(const RedisConfig& cfg, Handler handler)
+    : redis_(make_subscriber_redis(cfg)), handler_(std::move(handler)) {}
+
+RedisSubscriber::~RedisSubscriber() {
+    Stop();
+}
+
+void RedisSubscriber::Start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread([this] { Run(); });
+}
+
+void RedisSubscriber::Stop() {
+    if (!running_.exchange(false)) return;
+    // consume() 는 소켓 타임아웃마다 깨어나므로 그 안에 종료된다
+    if (thread_.joinable()) thread_.join();
+}
+
+void RedisSubscriber::Subscribe(const std::string& channel) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (channels_.insert(channel).second) pending_.emplace_back(true, channel);
+}
+
+void RedisSubscriber::Unsubscribe(const std::string& channel) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (channels_.erase(channel) > 0) pending_.emplace_back(false, channel);
+}
+
+void RedisSubscriber::ApplyPending(sw::redis::Subscriber& sub) {
+    std::vector<std::pair<bool, std::string>> ops;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ops.swap(pending_);
+    }
+    for (auto& [subscribe, channel] : ops) {
+        if (subscribe) sub.subscribe(channel);
+        else sub.unsubscribe(channel);
+    }
+}
+
+void RedisSubscriber::Run() {
+    while (running_) {
+        try {
+            auto sub = redis_.subscriber();
+            sub.on_message([this](std::string channel, std::string message) {
+                try { handler_(std::move(channel), std::move(message)); } catch (...) {}
+            });
+
+            // (재)연결: 현재 채널 전체를 구독하고 밀린 요청은 버린다
+            std::vector<std::string> all;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_.clear();
+                all.assign(channels_.begin(), channels_.end());
+            }
+            if (!all.empty()) sub.subscribe(all.begin(), all.end());
+
+            while (running_) {
+                ApplyPending(sub);
+                try {
+                    sub.consume();
+                } catch (const sw::redis::TimeoutError&) {
+                    // 주기적으로 깨어나 구독 변경/종료를 확인
+                }
+            }
+        } catch (...) {
+            // 연결 오류: 잠시 쉬고 재연결
+            if (running_) std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        }
+    }
+}
+
+} // namespace cache
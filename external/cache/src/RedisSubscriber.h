@@ -0,0 +1,52 @@
+#pragma once
+#include "RedisClient.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// 전용 스레드에서 SUBSCRIBE 커넥션을 돌리는 구독자.
+// sw::redis::Subscriber 는 스레드 안전하지 않으므로 Subscribe/Unsubscribe 는 요청만
+// 쌓아두고, 구독 스레드가 consume() 사이(소켓 타임아웃마다)에 반영한다.
+// 커넥션이 끊기면 다시 만들고 현재 채널을 모두 재구독한다.
+class RedisSubscriber {
+public:
+    // 구독 스레드에서 호출된다. 오래 걸리는 작업은 다른 executor 로 넘길 것.
+    using Handler = std::function<void(std::string channel, std::string message)>;
+
+    // cfg 의 주소/인증으로 별도 커넥션을 연다. (socket_timeout 은 폴링 주기로 쓰인다)
+    RedisSubscriber(const RedisConfig& cfg, Handler handler);
+    ~RedisSubscriber();
+
+    RedisSubscriber(const RedisSubscriber&) = delete;
+    RedisSubscriber& operator=(const RedisSubscriber&) = delete;
+
+    void Start();
+    void Stop();
+
+    // 어느 스레드에서든 호출 가능
+    void Subscribe(const std::string& channel);
+    void Unsubscribe(const std::string& channel);
+
+private:
+    void Run();
+    void ApplyPending(sw::redis::Subscriber& sub);
+
+    sw::redis::Redis redis_;
+    Handler handler_;
+
+    std::mutex mutex_;
+    std::unordered_set<std::string> channels_;             // 구독해야 할 채널
+    std::vector<std::pair<bool, std::string>> pending_;    // (subscribe?, channel)
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+} // namespace cache
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <yaml-cpp/yaml.h>
 #include <nlohmann/json.hpp>
@@ -7,6 +8,10 @@
 struct ServerConfig {
     std::string host;
     int port{};
+    // "shared": io_context 1개 + 세션 strand (기본)
+    // "per_core": 코어마다 io_context/acceptor(SO_REUSEPORT), 세션은 코어에 고정
+    std::string io_mode = "shared";
+    int io_threads{}; // 0 이면 hardware_concurrency
 };
 
 struct DatabaseConfig {
@@ -22,6 +27,44 @@ struct RedisConfig {
     int pool_size{};
 };
 
+struct SendQueueConfig {
+    std::size_t max_bytes = 1024 * 1024;
+    std::size_t max_messages = 4096;
+    std::string policy = "drop_oldest"; // drop_oldest | drop_newest | disconnect
+    std::size_t global_max_bytes = 512 * 1024 * 1024;
+};
+
+struct HistoryConfig {
+    std::size_t max_messages = 100;     // 방별 최근 메시지 개수 (0 = 보관 안 함)
+    std::size_t max_bytes = 256 * 1024; // 방별 최근 메시지 바이트
+    std::size_t redis_max_messages = 200;  // 방별 Redis 히스토리 리스트 길이 (0 = 끔)
+    int redis_ttl_seconds = 24 * 60 * 60;  // Redis 히스토리 보관 기간
+};
+
+struct PubSubConfig {
+    bool enabled = true;   // 노드 간 방 브로드캐스트 (Redis pub/sub)
+    bool loopback = false; // 자기 메시지도 Redis 를 거쳐 받는다 (로컬 테스트용)
+    std::string node_id;   // 비어 있으면 랜덤
+};
+
+struct NearCacheConfig {
+    bool enabled = true;                  // 프로세스 L1 (유저 조회)
+    std::size_t max_entries = 100000;
+    std::size_t max_bytes = 64 * 1024 * 1024;
+    int ttl_seconds = 30;                 // L1 보관 기간
+    double refresh_ahead = 0.8;           // ttl 의 이 비율 이후 조회되면 미리 갱신 (0 = 끔)
+    int redis_ttl_seconds = 300;          // L2(Redis) 보관 기간
+};
+
+struct LoggingConfig {
+    std::string level = "info";           // 런타임 레벨 (컴파일 타임 SPDLOG_ACTIVE_LEVEL 이하는 이미 제거됨)
+    std::size_t async_queue_size = 8192;  // 비동기 로거 큐 (가득 차면 overflow 정책)
+    std::string overflow = "overrun_oldest"; // overrun_oldest | block
+    std::uint32_t chat_sample_every_n = 1000;  // 채팅 로그 1/N, 0 = 끔
+    std::uint32_t query_sample_every_n = 1000; // 쿼리 시간 로그 1/N, 0 = 끔
+    int slow_query_ms = 100;              // 이 이상 걸린 쿼리는 항상 WARN
+};
+
 // ✅ YAML 매핑
 namespace YAML {
     template<>
@@ -30,12 +73,16 @@ namespace YAML {
             Node node;
             node["host"] = rhs.host;
             node["port"] = rhs.port;
+            node["io_mode"] = rhs.io_mode;
+            node["io_threads"] = rhs.io_threads;
             return node;
         }
         static bool decode(const Node& node, ServerConfig& rhs) {
             if(!node.IsMap()) return false;
             rhs.host = node["host"].as<std::string>();
             rhs.port = node["port"].as<int>();
+            if (node["io_mode"]) rhs.io_mode = node["io_mode"].as<std::string>();
+            if (node["io_threads"]) rhs.io_threads = node["io_threads"].as<int>();
             return true;
         }
     };
@@ -80,6 +127,112 @@ namespace YAML {
             return true;
         }
     };
+
+    template<>
+    struct convert<SendQueueConfig> {
+        static Node encode(const SendQueueConfig& rhs) {
+            Node node;
+            node["max_bytes"] = rhs.max_bytes;
+            node["max_messages"] = rhs.max_messages;
+            node["policy"] = rhs.policy;
+            node["global_max_bytes"] = rhs.global_max_bytes;
+            return node;
+        }
+        static bool decode(const Node& node, SendQueueConfig& rhs) {
+            if(!node.IsMap()) return false;
+            if (node["max_bytes"]) rhs.max_bytes = node["max_bytes"].as<std::size_t>();
+            if (node["max_messages"]) rhs.max_messages = node["max_messages"].as<std::size_t>();
+            if (node["policy"]) rhs.policy = node["policy"].as<std::string>();
+            if (node["global_max_bytes"]) rhs.global_max_bytes = node["global_max_bytes"].as<std::size_t>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<HistoryConfig> {
+        static Node encode(const HistoryConfig& rhs) {
+            Node node;
+            node["max_messages"] = rhs.max_messages;
+            node["max_bytes"] = rhs.max_bytes;
+            node["redis_max_messages"] = rhs.redis_max_messages;
+            node["redis_ttl_seconds"] = rhs.redis_ttl_seconds;
+            return node;
+        }
+        static bool decode(const Node& node, HistoryConfig& rhs) {
+            if(!node.IsMap()) return false;
+            if (node["max_messages"]) rhs.max_messages = node["max_messages"].as<std::size_t>();
+            if (node["max_bytes"]) rhs.max_bytes = node["max_bytes"].as<std::size_t>();
+            if (node["redis_max_messages"]) rhs.redis_max_messages = node["redis_max_messages"].as<std::size_t>();
+            if (node["redis_ttl_seconds"]) rhs.redis_ttl_seconds = node["redis_ttl_seconds"].as<int>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<PubSubConfig> {
+        static Node encode(const PubSubConfig& rhs) {
+            Node node;
+            node["enabled"] = rhs.enabled;
+            node["loopback"] = rhs.loopback;
+            node["node_id"] = rhs.node_id;
+            return node;
+        }
+        static bool decode(const Node& node, PubSubConfig& rhs) {
+            if(!node.IsMap()) return false;
+            if (node["enabled"]) rhs.enabled = node["enabled"].as<bool>();
+            if (node["loopback"]) rhs.loopback = node["loopback"].as<bool>();
+            if (node["node_id"]) rhs.node_id = node["node_id"].as<std::string>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<NearCacheConfig> {
+        static Node encode(const NearCacheConfig& rhs) {
+            Node node;
+            node["enabled"] = rhs.enabled;
+            node["max_entries"] = rhs.max_entries;
+            node["max_bytes"] = rhs.max_bytes;
+            node["ttl_seconds"] = rhs.ttl_seconds;
+            node["refresh_ahead"] = rhs.refresh_ahead;
+            node["redis_ttl_seconds"] = rhs.redis_ttl_seconds;
+            return node;
+        }
+        static bool decode(const Node& node, NearCacheConfig& rhs) {
+            if(!node.IsMap()) return false;
+            if (node["enabled"]) rhs.enabled = node["enabled"].as<bool>();
+            if (node["max_entries"]) rhs.max_entries = node["max_entries"].as<std::size_t>();
+            if (node["max_bytes"]) rhs.max_bytes = node["max_bytes"].as<std::size_t>();
+            if (node["ttl_seconds"]) rhs.ttl_seconds = node["ttl_seconds"].as<int>();
+            if (node["refresh_ahead"]) rhs.refresh_ahead = node["refresh_ahead"].as<double>();
+            if (node["redis_ttl_seconds"]) rhs.redis_ttl_seconds = node["redis_ttl_seconds"].as<int>();
+            return true;
+        }
+    };
+
+    template<>
+    struct convert<LoggingConfig> {
+        static Node encode(const LoggingConfig& rhs) {
+            Node node;
+            node["level"] = rhs.level;
+            node["async_queue_size"] = rhs.async_queue_size;
+            node["overflow"] = rhs.overflow;
+            node["chat_sample_every_n"] = rhs.chat_sample_every_n;
+            node["query_sample_every_n"] = rhs.query_sample_every_n;
+            node["slow_query_ms"] = rhs.slow_query_ms;
+            return node;
+        }
+        static bool decode(const Node& node, LoggingConfig& rhs) {
+            if(!node.IsMap()) return false;
+            if (node["level"]) rhs.level = node["level"].as<std::string>();
+            if (node["async_queue_size"]) rhs.async_queue_size = node["async_queue_size"].as<std::size_t>();
+            if (node["overflow"]) rhs.overflow = node["overflow"].as<std::string>();
+            if (node["chat_sample_every_n"]) rhs.chat_sample_every_n = node["chat_sample_every_n"].as<std::uint32_t>();
+            if (node["query_sample_every_n"]) rhs.query_sample_every_n = node["query_sample_every_n"].as<std::uint32_t>();
+            if (node["slow_query_ms"]) rhs.slow_query_ms = node["slow_query_ms"].as<int>();
+            return true;
+        }
+    };
 }
 
 
@@ -87,12 +240,16 @@ namespace YAML {
 inline void to_json(nlohmann::json& j, const ServerConfig& v) {
     j = nlohmann::json{
         {"host", v.host}, 
-        {"port", v.port}};
+        {"port", v.port},
+        {"io_mode", v.io_mode},
+        {"io_threads", v.io_threads}};
 }
 
 inline void from_json(const nlohmann::json& j, ServerConfig& s) {
     j.at("host").get_to(s.host);
     j.at("port").get_to(s.port);
+    if (j.contains("io_mode")) j.at("io_mode").get_to(s.io_mode);
+    if (j.contains("io_threads")) j.at("io_threads").get_to(s.io_threads);
 }
 
 inline void to_json(nlohmann::json& j, const DatabaseConfig& v) {
@@ -123,3 +280,84 @@ inline void from_json(const nlohmann::json& j, RedisConfig& r) {
     j.at("url").get_to(r.url);
     j.at("pool_size").get_to(r.pool_size);
 }
+
+inline void to_json(nlohmann::json& j, const SendQueueConfig& v) {
+    j = nlohmann::json{
+        {"max_bytes", v.max_bytes},
+        {"max_messages", v.max_messages},
+        {"policy", v.policy},
+        {"global_max_bytes", v.global_max_bytes}};
+}
+
+inline void from_json(const nlohmann::json& j, SendQueueConfig& q) {
+    if (j.contains("max_bytes")) j.at("max_bytes").get_to(q.max_bytes);
+    if (j.contains("max_messages")) j.at("max_messages").get_to(q.max_messages);
+    if (j.contains("policy")) j.at("policy").get_to(q.policy);
+    if (j.contains("global_max_bytes")) j.at("global_max_bytes").get_to(q.global_max_bytes);
+}
+
+inline void to_json(nlohmann::json& j, const HistoryConfig& v) {
+    j = nlohmann::json{
+        {"max_messages", v.max_messages},
+        {"max_bytes", v.max_bytes},
+        {"redis_max_messages", v.redis_max_messages},
+        {"redis_ttl_seconds", v.redis_ttl_seconds}};
+}
+
+inline void from_json(const nlohmann::json& j, HistoryConfig& h) {
+    if (j.contains("max_messages")) j.at("max_messages").get_to(h.max_messages);
+    if (j.contains("max_bytes")) j.at("max_bytes").get_to(h.max_bytes);
+    if (j.contains("redis_max_messages")) j.at("redis_max_messages").get_to(h.redis_max_messages);
+    if (j.contains("redis_ttl_seconds")) j.at("redis_ttl_seconds").get_to(h.redis_ttl_seconds);
+}
+
+inline void to_json(nlohmann::json& j, const PubSubConfig& v) {
+    j = nlohmann::json{
+        {"enabled", v.enabled},
+        {"loopback", v.loopback},
+        {"node_id", v.node_id}};
+}
+
+inline void from_json(const nlohmann::json& j, PubSubConfig& p) {
+    if (j.contains("enabled")) j.at("enabled").get_to(p.enabled);
+    if (j.contains("loopback")) j.at("loopback").get_to(p.loopback);
+    if (j.contains("node_id")) j.at("node_id").get_to(p.node_id);
+}
+
+inline void to_json(nlohmann::json& j, const NearCacheConfig& v) {
+    j = nlohmann::json{
+        {"enabled", v.enabled},
+        {"max_entries", v.max_entries},
+        {"max_bytes", v.max_bytes},
+        {"ttl_seconds", v.ttl_seconds},
+        {"refresh_ahead", v.refresh_ahead},
+        {"redis_ttl_seconds", v.redis_ttl_seconds}};
+}
+
+inline void from_json(const nlohmann::json& j, NearCacheConfig& n) {
+    if (j.contains("enabled")) j.at("enabled").get_to(n.enabled);
+    if (j.contains("max_entries")) j.at("max_entries").get_to(n.max_entries);
+    if (j.contains("max_bytes")) j.at("max_bytes").get_to(n.max_bytes);
+    if (j.contains("ttl_seconds")) j.at("ttl_seconds").get_to(n.ttl_seconds);
+    if (j.contains("refresh_ahead")) j.at("refresh_ahead").get_to(n.refresh_ahead);
+    if (j.contains("redis_ttl_seconds")) j.at("redis_ttl_seconds").get_to(n.redis_ttl_seconds);
+}
+
+inline void to_json(nlohmann::json& j, const LoggingConfig& v) {
+    j = nlohmann::json{
+        {"level", v.level},
+        {"async_queue_size", v.async_queue_size},
+        {"overflow", v.overflow},
+        {"chat_sample_every_n", v.chat_sample_every_n},
+        {"query_sample_every_n", v.query_sample_every_n},
+        {"slow_query_ms", v.slow_query_ms}};
+}
+
+inline void from_json(const nlohmann::json& j, LoggingConfig& l) {
+    if (j.contains("level")) j.at("level").get_to(l.level);
+    if (j.contains("async_queue_size")) j.at("async_queue_size").get_to(l.async_queue_size);
+    if (j.contains("overflow")) j.at("overflow").get_to(l.overflow);
+    if (j.contains("chat_sample_every_n")) j.at("chat_sample_every_n").get_to(l.chat_sample_every_n);
+    if (j.contains("query_sample_every_n")) j.at("query_sample_every_n").get_to(l.query_sample_every_n);
+    if (j.contains("slow_query_ms")) j.at("slow_query_ms").get_to(l.slow_query_ms);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/asio/buffer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ---- 와이어 프로토콜 ----
+// 접속 직후 클라이언트가 보낸 첫 바이트로 모드를 결정한다.
+//  - frame_preamble(0xFF) + protocol_version : framed 모드
+//  - 그 외                                    : 기존 newline 텍스트 모드
+// framed 로 전환되면 서버는 텍스트 라인 "+FRAMED 1\n" 을 마지막 텍스트로 보내고,
+// 이후 송신은 모두 프레임으로 인코딩한다. (클라이언트는 이 라인까지 텍스트로 읽으면 된다)
+//
+// frame = [length:u32 BE][type:u16 BE][flags:u16 BE][payload: length bytes]
+namespace protocol {
+
+constexpr std::uint8_t frame_preamble = 0xFF;
+constexpr std::uint8_t protocol_version = 1;
+constexpr std::size_t preamble_size = 2;
+constexpr std::size_t frame_header_size = 8;
+constexpr std::size_t max_frame_payload = 64 * 1024;
+constexpr std::size_t max_line_length = 64 * 1024;
+constexpr std::size_t read_chunk_size = 4096;
+constexpr std::string_view framed_ack = "+FRAMED 1";
+// 히스토리 페이지 끝에 보내는 다음 페이지 커서: "+HISTORY <created_us:shard_id:id>"
+constexpr std::string_view history_cursor_prefix = "+HISTORY ";
+
+enum class frame_type : std::uint16_t {
+    chat = 1,
+    join = 2,  // payload: 방 id (10진 문자열). 텍스트 모드에서는 "/join <id>"
+    login = 3, // payload: "username password". 텍스트 모드에서는 "/login <username> <password>"
+    history = 4, // payload: 커서 (비어 있으면 최신부터). 텍스트 모드에서는 "/history [cursor]"
+};
+
+struct frame_header {
+    std::uint32_t length{};
+    frame_type type{};
+    std::uint16_t flags{};
+};
+
+inline frame_header decode_header(const char* p) {
+    auto b = reinterpret_cast<const unsigned char*>(p);
+    frame_header h;
+    h.length = (std::uint32_t(b[0]) << 24) | (std::uint32_t(b[1]) << 16) |
+               (std::uint32_t(b[2]) << 8) | std::uint32_t(b[3]);
+    h.type = static_cast<frame_type>((b[4] << 8) | b[5]);
+    h.flags = static_cast<std::uint16_t>((b[6] << 8) | b[7]);
+    return h;
+}
+
+inline void encode_header(char* p, const frame_header& h) {
+    auto type = static_cast<std::uint16_t>(h.type);
+    p[0] = static_cast<char>(h.length >> 24);
+    p[1] = static_cast<char>(h.length >> 16);
+    p[2] = static_cast<char>(h.length >> 8);
+    p[3] = static_cast<char>(h.length);
+    p[4] = static_cast<char>(type >> 8);
+    p[5] = static_cast<char>(type);
+    p[6] = static_cast<char>(h.flags >> 8);
+    p[7] = static_cast<char>(h.flags);
+}
+
+inline std::string encode_frame(frame_type type, std::string_view payload) {
+    std::string out(frame_header_size + payload.size(), '\0');
+    encode_header(out.data(),
+                  frame_header{static_cast<std::uint32_t>(payload.size()), type, 0});
+    std::memcpy(out.data() + frame_header_size, payload.data(), payload.size());
+    return out;
+}
+
+inline std::string encode_line(std::string_view payload) {
+    std::string out;
+    out.reserve(payload.size() + 1);
+    out.append(payload);
+    out.push_back('\n');
+    return out;
+}
+
+// 세션별 재사용 수신 버퍼. 소켓에서 바로 읽어 들이고 파싱 결과는 view 로만 넘긴다.
+// data() 로 받은 view 는 다음 prepare()/consume() 전까지만 유효.
+class read_buffer {
+public:
+    explicit read_buffer(std::size_t initial = read_chunk_size) : buf_(initial) {}
+
+    boost::asio::mutable_buffer prepare(std::size_t min_free) {
+        if (buf_.size() - end_ < min_free && begin_ > 0) {
+            std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (buf_.size() - end_ < min_free) {
+            buf_.resize(std::max(buf_.size() * 2, end_ + min_free));
+        }
+        return boost::asio::buffer(buf_.data() + end_, buf_.size() - end_);
+    }
+
+    void commit(std::size_t n) { end_ += n; }
+
+    void consume(std::size_t n) {
+        begin_ += n;
+        if (begin_ == end_) begin_ = end_ = 0;
+    }
+
+    std::string_view data() const {
+        return std::string_view(buf_.data() + begin_, end_ - begin_);
+    }
+
+private:
+    std::vector<char> buf_;
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+};
+
+} // namespace protocol
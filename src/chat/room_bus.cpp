@@ -0,0 +1,81 @@
+#include "room_bus.h"
+#include <boost/asio/post.hpp>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include "server.h"
+
+static std::string random_node_id() {
+    std::random_device rd;
+    std::uint64_t v = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+room_bus::room_bus(cache::RedisClient& redis, room_manager& rooms, room_bus_options opts)
+    : redis_(redis), rooms_(rooms), opts_(std::move(opts)),
+      subscriber_(opts_.redis, [this](std::string channel, std::string message) {
+          on_message(channel, message);
+      }) {
+    if (opts_.node_id.empty()) opts_.node_id = random_node_id();
+}
+
+room_bus::~room_bus() {
+    stop();
+}
+
+void room_bus::start() {
+    SPDLOG_INFO("room bus start node={} loopback={}", opts_.node_id, opts_.loopback);
+    subscriber_.Start();
+}
+
+void room_bus::stop() {
+    subscriber_.Stop();
+    publisher_.join();
+}
+
+std::string room_bus::channel(db::RoomId id) {
+    return "room:" + std::to_string(id) + ":chat";
+}
+
+void room_bus::on_room_open(db::RoomId id) {
+    subscriber_.Subscribe(channel(id));
+}
+
+void room_bus::on_room_close(db::RoomId id) {
+    subscriber_.Unsubscribe(channel(id));
+}
+
+void room_bus::publish(db::RoomId id, std::string payload) {
+    boost::asio::post(publisher_, [this, id, payload = std::move(payload)] {
+        std::string message;
+        message.reserve(opts_.node_id.size() + 1 + payload.size());
+        message.append(opts_.node_id).push_back('\n');
+        message.append(payload);
+        if (redis_.Publish(channel(id), message) < 0) {
+            SPDLOG_WARN("room bus: publish failed room={}", id);
+        }
+    });
+}
+
+void room_bus::on_message(const std::string& channel, const std::string& message) {
+    // 구독 스레드. room::deliver 가 각 세션 executor(코어) 로 넘긴다
+    auto pos = message.find('\n');
+    if (pos == std::string::npos) return;
+    std::string_view origin(message.data(), pos);
+    if (!opts_.loopback && origin == opts_.node_id) return;
+
+    // "room:{id}:chat"
+    if (channel.compare(0, 5, "room:") != 0) return;
+    db::RoomId id = 0;
+    auto [ptr, ec] = std::from_chars(channel.data() + 5, channel.data() + channel.size(), id);
+    if (ec != std::errc()) return;
+
+    auto room = rooms_.find(id);
+    if (!room) return;
+    room->deliver(message.substr(pos + 1));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <boost/asio/thread_pool.hpp>
+#include <string>
+#include "RedisClient.h"
+#include "RedisSubscriber.h"
+#include "../db/models.h"
+
+class room_manager;
+
+// ---- 노드 간 방 브로드캐스트 (Redis pub/sub) ----
+// 방마다 채널 "room:{id}:chat" 하나. 채팅 메시지는 노드당 한 번만 publish 하고,
+// 각 노드는 받은 메시지를 자기 로컬 멤버에게만 fan-out 한다.
+// 방이 이 노드에 열려 있는 동안(로컬 멤버가 있는 동안)만 채널을 구독한다.
+//
+// 메시지 = "<origin node id>\n<payload>"
+//  - 기본: 보낸 노드는 로컬에 바로 전달하고, 돌아온 자기 메시지는 버린다
+//  - loopback: 로컬 전달 없이 publish 만 하고 돌아온 메시지로 전달한다
+//    (redis-server 하나로 전체 경로를 확인할 때)
+struct room_bus_options {
+    bool enabled = true;
+    bool loopback = false;
+    std::string node_id;        // 비어 있으면 시작 시 랜덤 생성
+    cache::RedisConfig redis;   // 구독 전용 커넥션 설정
+};
+
+class room_bus {
+public:
+    room_bus(cache::RedisClient& redis, room_manager& rooms, room_bus_options opts);
+    ~room_bus();
+
+    void start();
+    void stop();
+
+    bool loopback() const { return opts_.loopback; }
+    const std::string& node_id() const { return opts_.node_id; }
+
+    // room_manager 가 방을 만들고/지울 때 호출
+    void on_room_open(db::RoomId id);
+    void on_room_close(db::RoomId id);
+
+    // 다른 노드로 전달 (비동기, 방별 순서 유지)
+    void publish(db::RoomId id, std::string payload);
+
+    static std::string channel(db::RoomId id);
+
+private:
+    void on_message(const std::string& channel, const std::string& message);
+
+    cache::RedisClient& redis_;
+    room_manager& rooms_;
+    room_bus_options opts_;
+    boost::asio::thread_pool publisher_{1}; // publish 순서 유지를 위해 1개
+    cache::RedisSubscriber subscriber_;
+};
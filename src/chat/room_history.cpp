@@ -0,0 +1,155 @@
+#include "room_history.h"
+#include "../db/ModelCodec.h"
+#include <algorithm>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <charconv>
+#include <iterator>
+#include <spdlog/spdlog.h>
+
+room_history::room_history(cache::AsyncRedisClient& redis, DbFacade& db, std::size_t threads)
+    : redis_(redis), db_(db), pool_(threads) {}
+
+room_history::~room_history() {
+    pool_.join();
+}
+
+std::string room_history::key(db::RoomId room_id) {
+    return "room:" + std::to_string(room_id) + ":history";
+}
+
+std::string room_history::encode(const db::Message& msg) {
+    return cache::codec::Encode(msg);
+}
+
+bool room_history::decode(const std::string& data, db::Message& out) {
+    return cache::codec::TryDecode(data, out);
+}
+
+std::string room_history::format_cursor(const db::MessageCursor& cursor) {
+    return std::to_string(cursor.created_us) + ":" + std::to_string(cursor.shard_id) + ":" +
+           std::to_string(cursor.id);
+}
+
+std::optional<db::MessageCursor> room_history::parse_cursor(std::string_view text) {
+    db::MessageCursor c;
+    const char* p = text.data();
+    const char* end = text.data() + text.size();
+    auto field = [&](auto& out, bool last) {
+        auto [ptr, ec] = std::from_chars(p, end, out);
+        if (ec != std::errc() || out < 0) return false;
+        if (last) return ptr == end;
+        if (ptr == end || *ptr != ':') return false;
+        p = ptr + 1;
+        return true;
+    };
+    if (!field(c.created_us, false) || !field(c.shard_id, false) || !field(c.id, true))
+        return std::nullopt;
+    return c;
+}
+
+void room_history::append(db::Message msg) {
+    if (opts_.max_messages == 0) return;
+    db::RoomId room_id = msg.room_id;
+    {
+        std::lock_guard<std::mutex> lock(append_mutex_);
+        auto it = appending_.find(room_id);
+        if (it != appending_.end()) {
+            // 앞 파이프라인 응답 뒤에 이어서 보낸다
+            it->second.push_back(std::move(msg));
+            return;
+        }
+        appending_.emplace(room_id, std::vector<db::Message>{});
+    }
+    std::vector<db::Message> msgs;
+    msgs.push_back(std::move(msg));
+    send_appends(room_id, std::move(msgs));
+}
+
+void room_history::send_appends(db::RoomId room_id, std::vector<db::Message> msgs) {
+    // LPUSH... + LTRIM + EXPIRE 를 한 번의 왕복으로
+    auto k = key(room_id);
+    cache::RedisBatch batch;
+    for (auto& m : msgs) batch.LPush(k, encode(m));
+    batch.LTrim(k, 0, static_cast<long long>(opts_.max_messages) - 1);
+    if (opts_.ttl.count() > 0) batch.Expire(k, opts_.ttl);
+    redis_.Exec(std::move(batch), [this, room_id](std::vector<cache::BatchReply> replies) {
+        if (!replies.front().ok) {
+            SPDLOG_WARN("history: LPUSH failed room={}: {}", room_id, replies.front().error);
+        }
+        std::vector<db::Message> next;
+        {
+            std::lock_guard<std::mutex> lock(append_mutex_);
+            auto it = appending_.find(room_id);
+            if (it == appending_.end()) return;
+            if (it->second.empty()) {
+                appending_.erase(it);
+                return;
+            }
+            next.swap(it->second);
+        }
+        send_appends(room_id, std::move(next));
+    });
+}
+
+long long room_history::range_stop(const db::MessageCursor& before, std::size_t limit) const {
+    return before.empty() ? static_cast<long long>(limit) - 1
+                          : static_cast<long long>(opts_.max_messages) - 1;
+}
+
+std::vector<db::Message> room_history::select(const std::vector<std::string>& entries,
+                                              const db::MessageCursor& before,
+                                              std::size_t limit) {
+    std::vector<db::Message> out;
+    out.reserve(entries.size());
+    for (auto& e : entries) {
+        db::Message m;
+        if (!decode(e, m)) continue;
+        // 커서 정보가 없는 옛 항목은 건너뛴다 (DB 폴백이 채운다)
+        if (m.created_us == 0) continue;
+        if (!before.empty() && !(db::cursorOf(m) < before)) continue;
+        out.push_back(std::move(m));
+    }
+    // 샤드 writer 들의 저장 완료 순서와 커서 순서는 다를 수 있다
+    std::sort(out.begin(), out.end(), [](const db::Message& a, const db::Message& b) {
+        return db::cursorOf(b) < db::cursorOf(a);
+    });
+    if (out.size() > limit) out.resize(limit);
+    return out;
+}
+
+void room_history::load(db::RoomId room_id, const db::MessageCursor& before, std::size_t limit,
+                        messages_callback done) {
+    if (limit == 0) {
+        done({});
+        return;
+    }
+    // Redis 응답은 DB 폴백이 있을 수 있으므로 전용 스레드에서 받는다
+    auto on_cached = [this, room_id, before, limit,
+                      done = std::move(done)](std::vector<std::string> entries) {
+        auto msgs = select(entries, before, limit);
+        if (msgs.size() < limit) {
+            // miss 또는 Redis 창보다 오래된 부분만 샤드들에서
+            db::MessageCursor next = msgs.empty() ? before : db::cursorOf(msgs.back());
+            auto older = db_.loadRoomMessages(room_id, next, limit - msgs.size());
+            msgs.insert(msgs.end(), std::make_move_iterator(older.begin()),
+                        std::make_move_iterator(older.end()));
+        }
+        done(std::move(msgs));
+    };
+    if (opts_.max_messages == 0) {
+        boost::asio::post(pool_, [on_cached = std::move(on_cached)]() mutable { on_cached({}); });
+        return;
+    }
+    redis_.LRange(key(room_id), 0, range_stop(before, limit),
+                  boost::asio::bind_executor(pool_, std::move(on_cached)));
+}
+
+void room_history::load_cached(db::RoomId room_id, std::size_t limit, messages_callback done) {
+    if (limit == 0 || opts_.max_messages == 0) return;
+    // DB 를 타지 않으므로 Redis 워커에서 바로 완료
+    redis_.LRange(key(room_id), 0, range_stop(db::MessageCursor{}, limit),
+                  [limit, done = std::move(done)](std::vector<std::string> entries) {
+                      done(select(entries, db::MessageCursor{}, limit));
+                  });
+}
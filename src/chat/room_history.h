@@ -0,0 +1,83 @@
+#pragma once
+
+#include <boost/asio/thread_pool.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "AsyncRedisClient.h"
+#include "../db/DbFacade.h"
+#include "../db/models.h"
+
+// ---- 방 히스토리 캐시 계층 ----
+// 방마다 Redis 리스트 "room:{id}:history" 에 최근 메시지를 최신 → 과거 순으로 보관한다.
+//  - 쓰기: 샤드 INSERT 가 성공해 id 가 정해진 뒤 LPUSH + LTRIM (write-through).
+//    방마다 한 번에 하나의 파이프라인만 보내고, 그 사이 들어온 메시지는 모아
+//    다음 파이프라인으로 보낸다 (Redis 워커가 여럿이어도 방 안 순서 유지)
+//  - 읽기: Redis 먼저, 모자라거나 창 밖의 과거 페이지만 모든 샤드에서 조회해 합친다.
+//    방 메시지는 보낸 유저의 샤드에 나뉘어 있고 id 는 샤드마다 따로라서,
+//    페이지 커서는 db::MessageCursor (created_us, shard_id, id) 를 쓴다
+// 여러 채팅 노드가 같은 Redis 를 보면 최근 히스토리는 PostgreSQL 없이 공유된다.
+// Redis 는 AsyncRedisClient 로, DB 폴백은 전용 스레드에서 하므로 io 스레드/샤드 writer 를
+// 막지 않는다. 쓰기는 LPUSH/LTRIM/EXPIRE 를 파이프라인 한 번으로 보낸다.
+// 항목은 cache::codec 바이너리 포맷 (db/ModelCodec.h) 으로 저장한다.
+struct room_history_options {
+    std::size_t max_messages = 200;           // 방별 Redis 리스트 길이
+    std::chrono::seconds ttl{24 * 60 * 60};   // 마지막 메시지 이후 보관 기간
+};
+
+class room_history {
+public:
+    using messages_callback = std::function<void(std::vector<db::Message>)>;
+
+    // threads: DB 폴백용 스레드
+    room_history(cache::AsyncRedisClient& redis, DbFacade& db, std::size_t threads = 2);
+    ~room_history();
+
+    // 서버 시작 전(세션이 생기기 전)에만 호출
+    void configure(const room_history_options& opts) { opts_ = opts; }
+    const room_history_options& options() const { return opts_; }
+
+    // 저장이 끝난 메시지를 Redis 리스트에 추가 (비동기)
+    void append(db::Message msg);
+
+    // before 이전 최신 limit 개 (빈 커서면 최신부터), 커서 내림차순.
+    // Redis 에서 모자라는 부분은 모든 샤드에서 조회해 합친다 (DbFacade::loadRoomMessages).
+    // done 은 히스토리 스레드에서 호출된다.
+    void load(db::RoomId room_id, const db::MessageCursor& before, std::size_t limit,
+              messages_callback done);
+    // Redis 만 조회 (DB 폴백 없음). 빈 방 링을 채울 때 (chat_session::warm_history)
+    void load_cached(db::RoomId room_id, std::size_t limit, messages_callback done);
+
+    static std::string key(db::RoomId room_id);
+    static std::string encode(const db::Message& msg);
+    static bool decode(const std::string& data, db::Message& out);
+
+    // 클라이언트에 주고받는 커서 문자열 "created_us:shard_id:id"
+    static std::string format_cursor(const db::MessageCursor& cursor);
+    static std::optional<db::MessageCursor> parse_cursor(std::string_view text);
+
+private:
+    // 방의 대기 메시지를 파이프라인 하나로 보내고, 응답이 오면 그 사이 쌓인 것을 보낸다
+    void send_appends(db::RoomId room_id, std::vector<db::Message> msgs);
+    // 최신 페이지는 필요한 만큼만, 과거 페이지는 창 전체를 LRANGE 한다
+    long long range_stop(const db::MessageCursor& before, std::size_t limit) const;
+    // LRANGE 결과에서 before 이전 limit 개를 골라 디코딩 (커서 내림차순)
+    static std::vector<db::Message> select(const std::vector<std::string>& entries,
+                                           const db::MessageCursor& before,
+                                           std::size_t limit);
+
+    cache::AsyncRedisClient& redis_;
+    DbFacade& db_;
+    room_history_options opts_;
+    boost::asio::thread_pool pool_;
+
+    // 방별로 보내는 중인 파이프라인이 있으면 항목이 있고, 값은 그 뒤에 쌓인 메시지
+    std::mutex append_mutex_;
+    std::unordered_map<db::RoomId, std::vector<db::Message>> appending_;
+};
@@ -1,106 +1,589 @@
 #include <mutex>
 #include "server.h"
-#include <iostream>
+#include <charconv>
+#include <cstring>
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 // DB 추가
 #include "../db/DbFacade.h"
 #include "ConfigManager.h"
 #include "RedisClient.h"
+#include "AsyncRedisClient.h"
+#include "CacheInvalidator.h"
+#include "NearCache.h"
 #include "ConfigTypes.h"
+#include "room_bus.h"
+#include "room_history.h"
+#include "../db/ModelCodec.h"
+#include "../db/QueryLog.h"
+#include <boost/asio/thread_pool.hpp>
 
 DbFacade g_db("dbname=account_db user=root password=password host=localhost");
 
 cache::RedisClient g_cache(cache::RedisConfig{ .url = "tcp://127.0.0.1:6379" });
+// io 스레드에서 쓰는 Redis 호출은 이쪽으로 (RTT 동안 코어를 막지 않는다)
+cache::AsyncRedisClient g_async_cache(g_cache);
+
+room_history g_history(g_async_cache, g_db);
+
+// 유저 조회 L1 (start_user_cache 에서 생성). 미리 갱신은 g_cache_refresh 에서
+std::unique_ptr<cache::NearCache<db::User>> g_user_cache;
+std::unique_ptr<cache::CacheInvalidator> g_cache_invalidator;
+boost::asio::thread_pool g_cache_refresh{1};
 // chat_session 구현
 
-chat_session::chat_session(tcp::socket socket, chat_room& room)
-    : socket_(std::move(socket)), room_(room), strand_(socket_.get_executor()) {}
+// per_core 모드에서 현재 스레드가 담당하는 코어 (그 외 스레드는 no_core)
+constexpr std::size_t no_core = static_cast<std::size_t>(-1);
+thread_local std::size_t t_current_core = no_core;
+
+// SO_REUSEPORT: 코어별 acceptor 가 같은 포트를 나눠 받는다
+using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+send_queue_stats g_send_queue_stats;
+
+// 채팅 본문 로그는 1/N 만 INFO 로 남긴다 (전체 본문은 DEBUG 빌드에서만)
+LogSampler g_chat_log_sampler(1000);
+
+overflow_policy parse_overflow_policy(std::string_view name) {
+    if (name == "drop_newest") return overflow_policy::drop_newest;
+    if (name == "disconnect") return overflow_policy::disconnect;
+    return overflow_policy::drop_oldest;
+}
+
+// framed 전환 ack. 모든 세션이 공유하고, drop_oldest 로 버리지 않는다.
+static const message_buffer framed_ack_buffer =
+    std::make_shared<const std::string>(protocol::encode_line(protocol::framed_ack));
+
+chat_session::chat_session(tcp::socket socket, boost::asio::any_io_executor executor,
+                           room_manager& rooms, const send_queue_limits& limits,
+                           std::size_t core)
+    : socket_(std::move(socket)), rooms_(rooms), limits_(limits),
+      executor_(std::move(executor)), core_(core) {}
+
+chat_session::~chat_session() {
+    g_send_queue_stats.queued_bytes -= queued_bytes_;
+}
+
+void chat_session::close() {
+    boost::system::error_code ignored;
+    socket_.close(ignored);
+}
 
 void chat_session::start() {
-    room_.join(shared_from_this());
-    do_read();
+    auto self = shared_from_this();
+    boost::asio::dispatch(executor_, [this, self] {
+        join_room(default_room_id);
+        do_read();
+    });
+}
+
+void chat_session::join_room(db::RoomId id) {
+    if (room_ && room_->id() == id) return;
+    leave_room();
+    room_ = rooms_.join(id, shared_from_this());
+    warm_history();
+}
+
+void chat_session::warm_history() {
+    // 로그인 전이거나 링을 안 쓰면 (history.max_messages: 0) Redis 를 조회하지 않는다
+    if (!login_ || !room_ || !room_->history_seedable()) return;
+    auto self = shared_from_this();
+    db::RoomId id = room_->id();
+    g_history.load_cached(id, history_page_size,
+                          [this, self, id](std::vector<db::Message> msgs) {
+        if (msgs.empty()) return;
+        boost::asio::post(executor_, [this, self, id, msgs = std::move(msgs)] {
+            if (!room_ || room_->id() != id) return;
+            std::vector<encoded_message_ptr> older;
+            older.reserve(msgs.size());
+            for (auto it = msgs.rbegin(); it != msgs.rend(); ++it) {
+                older.push_back(make_encoded(it->content));
+            }
+            // 조회하는 동안 라이브 메시지를 받았으면 재생하지 않는다.
+            // 세션 executor 위라서 이후 브로드캐스트는 재생분 뒤에 큐에 들어간다
+            if (!room_->seed_history(older)) return;
+            for (auto& m : older) deliver(m);
+            deliver(std::string(protocol::history_cursor_prefix) +
+                    room_history::format_cursor(db::cursorOf(msgs.back())));
+        });
+    });
+}
+
+void chat_session::on_history(std::string_view before) {
+    if (!room_) return;
+    if (!login_) {
+        deliver("Please login first: /login <username> <password>");
+        return;
+    }
+    db::MessageCursor cursor;
+    if (!before.empty()) {
+        auto parsed = room_history::parse_cursor(before);
+        if (!parsed) {
+            SPDLOG_WARN("invalid history cursor: {}", before);
+            return;
+        }
+        cursor = *parsed;
+    }
+
+    auto self = shared_from_this();
+    db::RoomId id = room_->id();
+    g_history.load(id, cursor, history_page_size,
+                   [this, self, id](std::vector<db::Message> msgs) {
+                       deliver_history(id, std::move(msgs));
+                   });
+}
+
+void chat_session::deliver_history(db::RoomId room_id, std::vector<db::Message> msgs) {
+    if (msgs.empty()) return;
+    auto self = shared_from_this();
+    // 히스토리 스레드 → 세션 executor 로 복귀
+    boost::asio::post(executor_, [this, self, room_id, msgs = std::move(msgs)] {
+        if (!room_ || room_->id() != room_id) return;
+        for (auto it = msgs.rbegin(); it != msgs.rend(); ++it) deliver(it->content);
+        // 다음(더 과거) 페이지 요청에 쓸 커서
+        deliver(std::string(protocol::history_cursor_prefix) +
+                room_history::format_cursor(db::cursorOf(msgs.back())));
+    });
+}
+
+void chat_session::leave_room() {
+    if (!room_) return;
+    rooms_.leave(room_->id(), shared_from_this());
+    room_.reset();
+}
+
+encoded_message_ptr make_encoded(std::string_view payload) {
+    return std::make_shared<const encoded_message>(encoded_message{
+        protocol::encode_line(payload),
+        protocol::encode_frame(protocol::frame_type::chat, payload)});
 }
 
 void chat_session::deliver(const message& msg) {
+    deliver(make_encoded(msg));
+}
+
+void chat_session::deliver(encoded_message_ptr msg) {
     auto self = shared_from_this();
-    boost::asio::post(strand_, [this, self, msg] {
-        bool writing = !write_msgs_.empty();
-        write_msgs_.push_back(msg);
-        if (!writing) do_write();
+    // 이미 소유 코어/strand 위라면 바로 실행된다
+    boost::asio::dispatch(executor_, [this, self, msg = std::move(msg)] {
+        // 세션 모드에 맞는 인코딩을 가리키는 aliasing 포인터 (refcount 만 증가)
+        const std::string* buf = mode_ == wire_mode::framed ? &msg->frame : &msg->line;
+        enqueue(message_buffer(msg, buf));
     });
 }
 
+bool chat_session::over_limit(std::size_t incoming) const {
+    return queued_bytes_ + incoming > limits_.max_bytes ||
+           write_msgs_.size() + 1 > limits_.max_messages ||
+           g_send_queue_stats.queued_bytes.load(std::memory_order_relaxed) + incoming >
+               limits_.global_max_bytes;
+}
+
+void chat_session::enqueue(message_buffer buf) {
+    if (!socket_.is_open()) return;
+
+    const std::size_t size = buf->size();
+    if (buf != framed_ack_buffer && over_limit(size)) {
+        switch (limits_.policy) {
+        case overflow_policy::drop_newest:
+            ++g_send_queue_stats.dropped_newest;
+            return;
+        case overflow_policy::disconnect:
+            ++g_send_queue_stats.disconnects;
+            SPDLOG_WARN("slow consumer, disconnect (queued {} bytes)", queued_bytes_);
+            close();
+            return;
+        case overflow_policy::drop_oldest: {
+            // 전송 중인 앞쪽 write_in_flight_ 개는 건드릴 수 없다
+            std::size_t i = write_in_flight_;
+            while (over_limit(size) && i < write_msgs_.size()) {
+                if (write_msgs_[i] == framed_ack_buffer) {
+                    ++i;
+                    continue;
+                }
+                queued_bytes_ -= write_msgs_[i]->size();
+                g_send_queue_stats.queued_bytes -= write_msgs_[i]->size();
+                write_msgs_.erase(write_msgs_.begin() + i);
+                ++g_send_queue_stats.dropped_oldest;
+            }
+            if (over_limit(size)) {
+                ++g_send_queue_stats.dropped_newest;
+                return;
+            }
+            break;
+        }
+        }
+    }
+
+    bool writing = !write_msgs_.empty();
+    write_msgs_.push_back(std::move(buf));
+    queued_bytes_ += size;
+    g_send_queue_stats.queued_bytes += size;
+    if (!writing) do_write();
+}
+
 void chat_session::do_read() {
     auto self = shared_from_this();
-    boost::asio::async_read_until(socket_, buffer_, '\n',
-        boost::asio::bind_executor(strand_,
-            [this, self](boost::system::error_code ec, std::size_t /*bytes*/) {
-                if (!ec) {
-                    std::istream is(&buffer_);
-                    std::string line;
-                    std::getline(is, line);
-                    std::cout << line << std::endl;
-                    SPDLOG_INFO("{}", line);
-
-                    if (!line.empty()) {
-                        // === DB 저장 예시 ===
-                        // 유저 이름은 임시 "Alice" 로 가정 (실제로는 로그인 로직 필요)
-                        auto user = g_db.findUser("Alice");
-                        if (user) {
-                            g_db.saveMessage(user->id, 1 /*room_id*/, line);
-                        } else {
-                            SPDLOG_WARN("not found user");
-                            
-                        }
-
-                        // 채팅방 브로드캐스트
-                        room_.deliver(line + "\n");
-                    }
-                    do_read();
-                } else {
-                    room_.leave(self);
+    socket_.async_read_some(read_buf_.prepare(protocol::read_chunk_size),
+        boost::asio::bind_executor(executor_,
+            [this, self](boost::system::error_code ec, std::size_t bytes) {
+                if (ec) {
+                    leave_room();
+                    return;
                 }
+                read_buf_.commit(bytes);
+                if (!process_input()) {
+                    SPDLOG_WARN("protocol error, close session");
+                    leave_room();
+                    close();
+                    return;
+                }
+                do_read();
             }));
 }
 
+bool chat_session::process_input() {
+    if (mode_ == wire_mode::unknown) {
+        auto data = read_buf_.data();
+        if (data.empty()) return true;
+        if (static_cast<std::uint8_t>(data[0]) != protocol::frame_preamble) {
+            mode_ = wire_mode::line;
+        } else {
+            if (data.size() < protocol::preamble_size) return true;
+            if (static_cast<std::uint8_t>(data[1]) != protocol::protocol_version) {
+                SPDLOG_WARN("unsupported protocol version {}", static_cast<int>(data[1]));
+                return false;
+            }
+            read_buf_.consume(protocol::preamble_size);
+            // ack 라인까지는 텍스트, 이후 송신부터 프레임
+            enqueue(framed_ack_buffer);
+            mode_ = wire_mode::framed;
+        }
+    }
+    return mode_ == wire_mode::framed ? process_frames() : process_lines();
+}
+
+bool chat_session::process_lines() {
+    for (;;) {
+        auto data = read_buf_.data();
+        auto pos = data.find('\n');
+        if (pos == std::string_view::npos) {
+            return data.size() <= protocol::max_line_length;
+        }
+        on_message(protocol::frame_type::chat, data.substr(0, pos));
+        read_buf_.consume(pos + 1);
+    }
+}
+
+bool chat_session::process_frames() {
+    for (;;) {
+        auto data = read_buf_.data();
+        if (data.size() < protocol::frame_header_size) return true;
+        auto header = protocol::decode_header(data.data());
+        if (header.length > protocol::max_frame_payload) {
+            SPDLOG_WARN("frame too large: {}", header.length);
+            return false;
+        }
+        if (data.size() < protocol::frame_header_size + header.length) return true;
+        on_message(header.type, data.substr(protocol::frame_header_size, header.length));
+        read_buf_.consume(protocol::frame_header_size + header.length);
+    }
+}
+
+void chat_session::on_message(protocol::frame_type type, std::string_view payload) {
+    switch (type) {
+    case protocol::frame_type::chat:
+        // 텍스트 모드는 명령도 chat 라인으로 들어온다
+        if (mode_ != wire_mode::framed && payload.substr(0, 6) == "/join ") {
+            on_message(protocol::frame_type::join, payload.substr(6));
+            return;
+        }
+        if (mode_ != wire_mode::framed && payload.substr(0, 7) == "/login ") {
+            on_message(protocol::frame_type::login, payload.substr(7));
+            return;
+        }
+        if (mode_ != wire_mode::framed &&
+            (payload == "/history" || payload.substr(0, 9) == "/history ")) {
+            on_message(protocol::frame_type::history, payload.substr(std::min<std::size_t>(9, payload.size())));
+            return;
+        }
+        on_chat(payload);
+        return;
+    case protocol::frame_type::login:
+        on_login(payload);
+        return;
+    case protocol::frame_type::history:
+        on_history(payload);
+        return;
+    case protocol::frame_type::join: {
+        db::RoomId id = 0;
+        auto [ptr, ec] = std::from_chars(payload.data(), payload.data() + payload.size(), id);
+        if (ec != std::errc() || id <= 0) {
+            SPDLOG_WARN("invalid room id: {}", payload);
+            return;
+        }
+        join_room(id);
+        return;
+    }
+    }
+    SPDLOG_WARN("unknown frame type {}", static_cast<int>(type));
+}
+
+void chat_session::on_login(std::string_view credentials) {
+    if (login_ || login_pending_) return;
+    auto sep = credentials.find(' ');
+    if (sep == std::string_view::npos || sep == 0 || sep + 1 == credentials.size()) {
+        deliver("Login failed: /login <username> <password>");
+        return;
+    }
+    std::string username(credentials.substr(0, sep));
+    std::string password(credentials.substr(sep + 1));
+    login_pending_ = true;
+
+    auto self = shared_from_this();
+    g_db.loginAsync(std::move(username), std::move(password),
+                    [this, self](std::optional<UserLogin> login) {
+        // DB 워커 스레드 → 세션 executor 로 복귀
+        boost::asio::post(executor_, [this, self, login = std::move(login)]() mutable {
+            login_pending_ = false;
+            if (!login) {
+                deliver("Login failed");
+                return;
+            }
+            SPDLOG_INFO("login user={} shard={}", login->user.username, login->shard_id);
+            login_ = std::move(login);
+            deliver("Logged in as " + login_->user.username);
+            warm_history();
+        });
+    });
+}
+
+void chat_session::on_chat(std::string_view payload) {
+    if (payload.empty() || !room_) return;
+    if (!login_) {
+        deliver("Please login first: /login <username> <password>");
+        return;
+    }
+
+    if (g_chat_log_sampler.sample()) {
+        SPDLOG_INFO("chat room={} user={} bytes={} (1/{} sampled)", room_->id(),
+                    login_->user.username, payload.size(), g_chat_log_sampler.everyN());
+    }
+    SPDLOG_DEBUG("chat room={} user={}: {}", room_->id(), login_->user.username, payload);
+
+    message line(payload);
+
+    // 로그인 때 받아둔 샤드 writer 로 바로 넘긴다 (account DB 조회 없음, 블록 없음).
+    // 저장돼 id 가 정해지면 Redis 히스토리에도 넣는다 (write-through)
+    g_db.saveMessageAsync(*login_, room_->id(), line,
+                          [](bool ok, const db::Message& saved) {
+                              if (ok) g_history.append(saved);
+                          });
+
+    // 다른 노드로는 방 채널에 한 번만 publish, 이 노드 멤버에게는 바로 fan-out.
+    // loopback 이면 Redis 에서 돌아온 메시지로만 전달한다
+    auto bus = rooms_.bus();
+    if (bus) bus->publish(room_->id(), line);
+    if (!bus || !bus->loopback()) room_->deliver(line);
+}
+
 void chat_session::do_write() {
+    // 큐에 쌓인 메시지를 한도 내에서 모아 한 번의 writev 로 보낸다
+    write_bufs_.clear();
+    std::size_t bytes = 0;
+    for (auto& m : write_msgs_) {
+        if (!write_bufs_.empty() &&
+            (write_bufs_.size() >= max_write_buffers || bytes + m->size() > max_write_bytes)) {
+            break;
+        }
+        write_bufs_.push_back(boost::asio::buffer(*m));
+        bytes += m->size();
+    }
+    write_in_flight_ = write_bufs_.size();
+
     auto self = shared_from_this();
-    boost::asio::async_write(socket_,
-        boost::asio::buffer(write_msgs_.front().data(), write_msgs_.front().size()),
-        boost::asio::bind_executor(strand_,
+    boost::asio::async_write(socket_, write_bufs_,
+        boost::asio::bind_executor(executor_,
             [this, self](boost::system::error_code ec, std::size_t /*bytes*/) {
                 if (!ec) {
-                    write_msgs_.pop_front();
+                    // 전송 완료된 엔트리 일괄 해제
+                    std::size_t sent = 0;
+                    for (std::size_t i = 0; i < write_in_flight_; ++i) {
+                        sent += write_msgs_[i]->size();
+                    }
+                    queued_bytes_ -= sent;
+                    g_send_queue_stats.queued_bytes -= sent;
+                    write_msgs_.erase(write_msgs_.begin(),
+                                      write_msgs_.begin() + write_in_flight_);
+                    write_in_flight_ = 0;
                     if (!write_msgs_.empty()) do_write();
                 } else {
                     SPDLOG_INFO("leave room");
-                    room_.leave(self);
+                    leave_room();
                 }
             }));
 }
 
+// message_ring 구현
+
+message_ring::message_ring(const history_limits& limits)
+    : slots_(limits.max_messages), max_bytes_(limits.max_bytes) {}
+
+void message_ring::push(encoded_message_ptr msg) {
+    if (slots_.empty()) return;
+    std::size_t c = cost(*msg);
+    if (c > max_bytes_) return; // 한도보다 큰 메시지는 보관하지 않는다
+    while (count_ == slots_.size() || (count_ > 0 && bytes_ + c > max_bytes_)) {
+        pop_front();
+    }
+    slots_[(head_ + count_) % slots_.size()] = std::move(msg);
+    ++count_;
+    bytes_ += c;
+}
+
+void message_ring::pop_front() {
+    bytes_ -= cost(*slots_[head_]);
+    slots_[head_].reset();
+    head_ = (head_ + 1) % slots_.size();
+    --count_;
+}
+
+void message_ring::snapshot(std::vector<encoded_message_ptr>& out) const {
+    out.reserve(out.size() + count_);
+    for (std::size_t i = 0; i < count_; ++i) {
+        out.push_back(slots_[(head_ + i) % slots_.size()]);
+    }
+}
+
 // chat_room 구현
 
+chat_room::chat_room(db::RoomId id, const core_executors& cores, const history_limits& history)
+    : id_(id), cores_(cores), members_(std::make_shared<const member_table>(cores.size())),
+      history_(history) {}
+
 void chat_room::join(std::shared_ptr<chat_session> session) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    sessions_.insert(session);
-    session->deliver("Welcome to the chat!\n");
+    std::vector<encoded_message_ptr> recent;
+    {
+        std::lock_guard<std::mutex> history_lock(history_mutex_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto next = std::make_shared<member_table>(*std::atomic_load(&members_));
+        (*next)[session->core()].push_back(session);
+        std::atomic_store(&members_, std::shared_ptr<const member_table>(std::move(next)));
+        history_.snapshot(recent);
+    }
+    // 세션 executor 위에서 호출되므로 재생분이 이후 브로드캐스트보다 먼저 큐에 들어간다
+    session->deliver("Welcome to the chat!");
+    for (auto& m : recent) session->deliver(m);
 }
 
-void chat_room::leave(std::shared_ptr<chat_session> session) {
+void chat_room::leave(const std::shared_ptr<chat_session>& session) {
     std::lock_guard<std::mutex> lock(mutex_);
-    sessions_.erase(session);
+    auto cur = std::atomic_load(&members_);
+    auto& list = (*cur)[session->core()];
+    auto it = std::find(list.begin(), list.end(), session);
+    if (it == list.end()) return;
+    auto next = std::make_shared<member_table>(*cur);
+    auto& next_list = (*next)[session->core()];
+    next_list.erase(next_list.begin() + (it - list.begin()));
+    std::atomic_store(&members_, std::shared_ptr<const member_table>(std::move(next)));
+}
+
+bool chat_room::history_seedable() {
+    std::lock_guard<std::mutex> lock(history_mutex_);
+    return history_.capacity() > 0 && !history_started_;
+}
+
+bool chat_room::seed_history(const std::vector<encoded_message_ptr>& older) {
+    std::lock_guard<std::mutex> lock(history_mutex_);
+    if (history_.capacity() == 0 || history_started_) return false;
+    history_started_ = true;
+    for (auto& m : older) history_.push(m);
+    return true;
+}
+
+bool chat_room::empty() const {
+    auto members = std::atomic_load(&members_);
+    return std::all_of(members->begin(), members->end(),
+                       [](const member_list& l) { return l.empty(); });
 }
 
 void chat_room::deliver(const message& msg) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& s : sessions_) s->deliver(msg);
+    // 멤버 수와 무관하게 인코딩은 한 번
+    deliver(make_encoded(msg));
+}
+
+void chat_room::deliver(const encoded_message_ptr& msg) {
+    // 기록 + 스냅샷만 락 안에서, fan-out 은 락 없이
+    std::shared_ptr<const member_table> members;
+    {
+        std::lock_guard<std::mutex> lock(history_mutex_);
+        history_.push(msg);
+        history_started_ = true;
+        members = std::atomic_load(&members_);
+    }
+    for (std::size_t core = 0; core < members->size(); ++core) {
+        if ((*members)[core].empty()) continue;
+        if (cores_.size() == 1 || core == t_current_core) {
+            for (auto& s : (*members)[core]) s->deliver(msg);
+            continue;
+        }
+        // 다른 코어 멤버: 그 코어로 메시지 1개만 넘기고 fan-out 은 그 코어 스레드가 한다
+        boost::asio::post(cores_[core], [members, core, msg] {
+            for (auto& s : (*members)[core]) s->deliver(msg);
+        });
+    }
+}
+
+// room_manager 구현
+
+room_manager::room_manager(core_executors cores, history_limits history)
+    : cores_(std::move(cores)), history_(history) {}
+
+std::shared_ptr<chat_room> room_manager::join(db::RoomId id,
+                                              std::shared_ptr<chat_session> session) {
+    auto& sh = shard_for(id);
+    std::lock_guard<std::mutex> lock(sh.mutex);
+    auto& room = sh.rooms[id];
+    if (!room) {
+        room = std::make_shared<chat_room>(id, cores_, history_);
+        if (bus_) bus_->on_room_open(id);
+    }
+    // 샤드 락 안에서 join 해야 빈 방 제거와 경합하지 않는다
+    room->join(std::move(session));
+    return room;
+}
+
+void room_manager::leave(db::RoomId id, const std::shared_ptr<chat_session>& session) {
+    auto& sh = shard_for(id);
+    std::lock_guard<std::mutex> lock(sh.mutex);
+    auto it = sh.rooms.find(id);
+    if (it == sh.rooms.end()) return;
+    it->second->leave(session);
+    if (it->second->empty()) {
+        sh.rooms.erase(it);
+        if (bus_) bus_->on_room_close(id);
+    }
+}
+
+std::shared_ptr<chat_room> room_manager::find(db::RoomId id) {
+    auto& sh = shard_for(id);
+    std::lock_guard<std::mutex> lock(sh.mutex);
+    auto it = sh.rooms.find(id);
+    return it == sh.rooms.end() ? nullptr : it->second;
 }
 
 // chat_server 구현
 
-chat_server::chat_server(boost::asio::io_context& io, const tcp::endpoint& ep)
-    : acceptor_(io, ep) {
+chat_server::chat_server(boost::asio::io_context& io, const tcp::endpoint& ep,
+                         room_manager& rooms, const send_queue_limits& limits,
+                         std::size_t core, bool per_core)
+    : acceptor_(io), rooms_(rooms), limits_(limits), core_(core), per_core_(per_core) {
+    acceptor_.open(ep.protocol());
+    acceptor_.set_option(tcp::acceptor::reuse_address(true));
+    if (per_core_) acceptor_.set_option(reuse_port(true));
+    acceptor_.bind(ep);
+    acceptor_.listen();
     do_accept();
 }
 
@@ -108,24 +591,231 @@ void chat_server::do_accept() {
     acceptor_.async_accept(
         [this](boost::system::error_code ec, tcp::socket socket) {
             if (!ec) {
-                std::make_shared<chat_session>(std::move(socket), room_)->start();
+                // per_core: 코어 io_context 에 고정 (스레드 1개라 strand 불필요)
+                boost::asio::any_io_executor ex = socket.get_executor();
+                if (!per_core_) ex = boost::asio::make_strand(ex);
+                std::make_shared<chat_session>(std::move(socket), std::move(ex), rooms_,
+                                               limits_, core_)
+                    ->start();
             }
             SPDLOG_INFO("accept client");
             do_accept();
         });
 }
 
+static void pin_to_core(std::size_t core) {
+#ifdef __linux__
+    // 코어 수를 알 수 없으면 (0) 고정하지 않는다
+    unsigned cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) {
+        SPDLOG_WARN("pin core {}: cpu count unknown, not pinned", core);
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cpus, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        SPDLOG_WARN("pin core {} to cpu {} failed: {}", core, core % cpus, std::strerror(rc));
+    }
+#else
+    (void)core; // macOS 는 affinity API 가 없어 고정하지 않는다
+#endif
+}
+
+// 송신 큐 메모리/드롭 카운터 주기 출력
+static void report_send_queue_stats(std::shared_ptr<boost::asio::steady_timer> timer) {
+    timer->expires_after(std::chrono::seconds(30));
+    timer->async_wait([timer](boost::system::error_code ec) {
+        if (ec) return;
+        SPDLOG_INFO("send queue: queued_bytes={} dropped_oldest={} dropped_newest={} "
+                    "disconnects={}",
+                    g_send_queue_stats.queued_bytes.load(),
+                    g_send_queue_stats.dropped_oldest.load(),
+                    g_send_queue_stats.dropped_newest.load(),
+                    g_send_queue_stats.disconnects.load());
+        report_send_queue_stats(timer);
+    });
+}
+
+// 노드 간 브로드캐스트 시작 (비활성이면 nullptr, 단일 노드로 동작)
+static std::unique_ptr<room_bus> start_bus(room_manager& rooms, const room_bus_options& opts) {
+    if (!opts.enabled) return nullptr;
+    auto bus = std::make_unique<room_bus>(g_cache, rooms, opts);
+    rooms.attach_bus(bus.get());
+    bus->start();
+    return bus;
+}
+
+static std::string user_cache_key(const std::string& username) {
+    return "user:" + username;
+}
+
+// findUser 앞단: 프로세스 L1 → Redis(L2) → account DB.
+// 같은 유저의 동시 miss 는 L1 에서 한 번으로 합쳐지고, 다른 노드의 변경은
+// cache:invalidate 채널로 받는다.
+static void start_user_cache(const NearCacheConfig& ncCfg, const cache::RedisConfig& redis) {
+    if (!ncCfg.enabled) return;
+
+    cache::NearCache<db::User>::Options opts;
+    opts.max_entries = ncCfg.max_entries;
+    opts.max_bytes = ncCfg.max_bytes;
+    opts.ttl = std::chrono::seconds(ncCfg.ttl_seconds);
+    opts.refresh_ahead = ncCfg.refresh_ahead;
+    opts.sizer = [](const std::string& key, const db::User& u) {
+        return sizeof(db::User) + key.size() * 2 + u.username.size() +
+               (u.email ? u.email->size() : 0);
+    };
+    opts.refresher = [](std::function<void()> job) {
+        boost::asio::post(g_cache_refresh, std::move(job));
+    };
+    g_user_cache = std::make_unique<cache::NearCache<db::User>>(std::move(opts));
+
+    g_cache_invalidator = std::make_unique<cache::CacheInvalidator>(g_cache, redis);
+    g_cache_invalidator->Register("user:", [](const std::string& key) {
+        g_user_cache->Invalidate(key);
+    });
+    g_cache_invalidator->Start();
+
+    auto redis_ttl = std::chrono::seconds(ncCfg.redis_ttl_seconds);
+    g_db.setUserCache(
+        [redis_ttl](const std::string& username, DbFacade::UserLoad load) {
+            auto key = user_cache_key(username);
+            return g_user_cache->GetOrLoad(key, [key, redis_ttl, load = std::move(load)] {
+                return g_cache.GetOrLoad<db::User>(key, redis_ttl, load, std::chrono::seconds(30));
+            });
+        },
+        [](const std::string& username) {
+            auto key = user_cache_key(username);
+            g_cache.Del(key);
+            g_cache_invalidator->Publish(key);
+        });
+    SPDLOG_INFO("user near-cache on: max_entries={} ttl={}s", ncCfg.max_entries, ncCfg.ttl_seconds);
+}
+
+// 기존 방식: io_context 1개를 여러 스레드가 공유, 세션 직렬화는 strand
+static void run_shared(unsigned short port, unsigned thread_count,
+                       const send_queue_limits& limits, const history_limits& history,
+                       const room_bus_options& bus_opts) {
+    boost::asio::io_context io;
+    room_manager rooms({io.get_executor()}, history);
+    auto bus = start_bus(rooms, bus_opts);
+    chat_server server(io, tcp::endpoint(tcp::v4(), port), rooms, limits);
+    report_send_queue_stats(std::make_shared<boost::asio::steady_timer>(io));
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; ++i) {
+        SPDLOG_INFO("io thread start");
+        threads.emplace_back([&]{ io.run(); });
+    }
+
+    SPDLOG_INFO("Chat server started on port {} (shared, {} threads)", port, thread_count);
+    io.run();
+    for (auto& t : threads) t.join();
+}
+
+// thread-per-core: 코어마다 io_context + SO_REUSEPORT acceptor + 고정 스레드
+static void run_per_core(unsigned short port, unsigned core_count,
+                         const send_queue_limits& limits, const history_limits& history,
+                         const room_bus_options& bus_opts) {
+    std::vector<std::unique_ptr<boost::asio::io_context>> ios;
+    core_executors cores;
+    for (unsigned i = 0; i < core_count; ++i) {
+        ios.push_back(std::make_unique<boost::asio::io_context>(1));
+        cores.push_back(ios.back()->get_executor());
+    }
+    room_manager rooms(cores, history);
+    auto bus = start_bus(rooms, bus_opts);
+
+    std::vector<std::unique_ptr<chat_server>> servers;
+    for (unsigned i = 0; i < core_count; ++i) {
+        servers.push_back(std::make_unique<chat_server>(
+            *ios[i], tcp::endpoint(tcp::v4(), port), rooms, limits, i, true));
+    }
+    report_send_queue_stats(std::make_shared<boost::asio::steady_timer>(*ios[0]));
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < core_count; ++i) {
+        threads.emplace_back([&, i] {
+            t_current_core = i;
+            pin_to_core(i);
+            ios[i]->run();
+        });
+    }
+
+    SPDLOG_INFO("Chat server started on port {} (per_core, {} cores)", port, core_count);
+    t_current_core = 0;
+    pin_to_core(0);
+    ios[0]->run();
+    for (auto& t : threads) t.join();
+}
+
+// 기본 로거를 bounded queue 비동기 로거로 교체한다.
+// 큐가 가득 차면 overrun_oldest 는 오래된 로그를 버리고, block 은 호출 스레드를 막는다.
+void init_logging(const LoggingConfig& logCfg) {
+    spdlog::init_thread_pool(std::max<std::size_t>(logCfg.async_queue_size, 1), 1);
+
+    std::shared_ptr<spdlog::logger> logger;
+    if (logCfg.overflow == "block") {
+        logger = spdlog::stdout_color_mt<spdlog::async_factory>("chat");
+    } else {
+        logger = spdlog::stdout_color_mt<spdlog::async_factory_nonblock>("chat");
+    }
+    spdlog::set_default_logger(logger);
+    spdlog::set_pattern("[%H:%M:%S.%e] [%l] [%s:%# %!] %v");
+    spdlog::set_level(spdlog::level::from_str(logCfg.level));
+    spdlog::flush_on(spdlog::level::warn);
+
+    g_chat_log_sampler.setEveryN(logCfg.chat_sample_every_n);
+    querylog::configure(logCfg.query_sample_every_n, logCfg.slow_query_ms);
+}
+
 int main(int argc, char* argv[]) {
     spdlog::set_pattern("[%H:%M:%S.%e] [%l] [%s:%# %!] %v");
 
     config::ConfigManager cfg;
+    ServerConfig srvCfg;
+    send_queue_limits queueLimits;
+    history_limits historyLimits;
+    room_bus_options busOpts;
+    NearCacheConfig nearCacheCfg;
+    LoggingConfig logCfg;
+
+    bool loaded = cfg.load("../config.yaml");
+    if (loaded && cfg.has("logging")) {
+        logCfg = cfg.getStruct<LoggingConfig>("logging");
+    }
+    init_logging(logCfg);
 
-    if(cfg.load("../config.yaml")) {
+    if(loaded) {
 
-        ServerConfig srvCfg = cfg.getStruct<ServerConfig>("server");
+        srvCfg = cfg.getStruct<ServerConfig>("server");
 
         SPDLOG_INFO("YAML server.host={}", srvCfg.host);
         SPDLOG_INFO("YAML server.port={}", srvCfg.port);
+        SPDLOG_INFO("YAML server.io_mode={}", srvCfg.io_mode);
+
+        if (cfg.has("send_queue")) {
+            SendQueueConfig sqCfg = cfg.getStruct<SendQueueConfig>("send_queue");
+            queueLimits.max_bytes = sqCfg.max_bytes;
+            queueLimits.max_messages = sqCfg.max_messages;
+            queueLimits.policy = parse_overflow_policy(sqCfg.policy);
+            queueLimits.global_max_bytes = sqCfg.global_max_bytes;
+            SPDLOG_INFO("YAML send_queue.policy={}", sqCfg.policy);
+        }
+
+        if (cfg.has("history")) {
+            HistoryConfig histCfg = cfg.getStruct<HistoryConfig>("history");
+            historyLimits.max_messages = histCfg.max_messages;
+            historyLimits.max_bytes = histCfg.max_bytes;
+            SPDLOG_INFO("YAML history.max_messages={}", histCfg.max_messages);
+
+            room_history_options redisHistory;
+            redisHistory.max_messages = histCfg.redis_max_messages;
+            redisHistory.ttl = std::chrono::seconds(histCfg.redis_ttl_seconds);
+            g_history.configure(redisHistory);
+            SPDLOG_INFO("YAML history.redis_max_messages={}", histCfg.redis_max_messages);
+        }
 
         DatabaseConfig dbCfg = cfg.getStruct<DatabaseConfig>("database");
 
@@ -137,14 +827,34 @@ int main(int argc, char* argv[]) {
 
         SPDLOG_INFO("YAML redis.url={}", redisCfg.url);
         SPDLOG_INFO("YAML redis.pool_size={}", redisCfg.pool_size);
+        if (!redisCfg.url.empty()) busOpts.redis.url = redisCfg.url;
+
+        if (cfg.has("near_cache")) {
+            nearCacheCfg = cfg.getStruct<NearCacheConfig>("near_cache");
+            SPDLOG_INFO("YAML near_cache.enabled={} ttl_seconds={}", nearCacheCfg.enabled,
+                        nearCacheCfg.ttl_seconds);
+        }
 
-        g_cache.Set("chat_server", "hahaha");
-        auto value = g_cache.Get("chat_server");
-        if (value) {
-            SPDLOG_INFO("cache test: {}", *value);
+        if (cfg.has("pubsub")) {
+            PubSubConfig psCfg = cfg.getStruct<PubSubConfig>("pubsub");
+            busOpts.enabled = psCfg.enabled;
+            busOpts.loopback = psCfg.loopback;
+            busOpts.node_id = psCfg.node_id;
+            SPDLOG_INFO("YAML pubsub.enabled={} loopback={}", psCfg.enabled, psCfg.loopback);
         }
+
+        g_async_cache.Set("chat_server", "hahaha", [](bool ok) {
+            if (!ok) return;
+            g_async_cache.Get("chat_server", [](std::optional<std::string> value) {
+                if (value) {
+                    SPDLOG_INFO("cache test: {}", *value);
+                }
+            });
+        });
     }
 
+    start_user_cache(nearCacheCfg, busOpts.redis);
+
     try {
 
         //SPDLOG_INFO("Hello, spdlog! number={}", 42);
@@ -155,18 +865,21 @@ int main(int argc, char* argv[]) {
         unsigned short port = 12345;
         if (argc >= 2) port = static_cast<unsigned short>(std::stoi(argv[1]));
 
-        boost::asio::io_context io;
-        chat_server server(io, tcp::endpoint(tcp::v4(), port));
+        unsigned thread_count = srvCfg.io_threads > 0
+                                    ? static_cast<unsigned>(srvCfg.io_threads)
+                                    : std::max(1u, std::thread::hardware_concurrency());
 
-        std::vector<std::thread> threads;
-        for (unsigned i = 1; i < std::thread::hardware_concurrency(); ++i) {
-            SPDLOG_INFO("io thread start");
-            threads.emplace_back([&]{ io.run(); });
+        if (srvCfg.io_mode == "per_core") {
+            run_per_core(port, thread_count, queueLimits, historyLimits, busOpts);
+        } else {
+            run_shared(port, thread_count, queueLimits, historyLimits, busOpts);
         }
-
-        SPDLOG_INFO("Chat server started on port {}", port);
-        io.run();
     } catch (std::exception& e) {
         SPDLOG_ERROR("exception: {}", e.what());
     }
+
+    if (g_cache_invalidator) g_cache_invalidator->Stop();
+
+    // 비동기 큐에 남은 로그를 비운다
+    spdlog::shutdown();
 }
\ No newline at end of file
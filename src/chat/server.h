@@ -1,56 +1,248 @@
 #pragma once
 
 #include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
-#include <set>
+#include <mutex>
 #include <deque>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "protocol.h"
+#include "../db/DbFacade.h"
+#include "../db/models.h"
 
 using boost::asio::ip::tcp;
 
 // ---- 채팅 메시지 큐 타입 ----
+// message 는 개행/프레임 헤더가 없는 순수 payload.
 using message = std::string;
-using message_queue = std::deque<message>;
+
+// 브로드캐스트 1회당 한 번만 인코딩되는 불변 payload.
+// 방의 모든 세션 송신 큐가 같은 버퍼를 공유한다.
+struct encoded_message {
+    std::string line;   // newline 모드용
+    std::string frame;  // framed 모드용
+};
+using encoded_message_ptr = std::shared_ptr<const encoded_message>;
+
+encoded_message_ptr make_encoded(std::string_view payload);
+
+// 큐 엔트리는 encoded_message 의 한쪽 인코딩을 가리키는 aliasing shared_ptr 라
+// push 시 문자열 복사/할당이 없다.
+using message_buffer = std::shared_ptr<const std::string>;
+using message_queue = std::deque<message_buffer>;
+
+// ---- 세션 송신 큐 제한 ----
+// 한도 초과 시 정책
+enum class overflow_policy { drop_oldest, drop_newest, disconnect };
+
+overflow_policy parse_overflow_policy(std::string_view name);
+
+struct send_queue_limits {
+    std::size_t max_bytes = 1024 * 1024;              // 세션당 큐 바이트
+    std::size_t max_messages = 4096;                  // 세션당 큐 메시지 수
+    overflow_policy policy = overflow_policy::drop_oldest;
+    std::size_t global_max_bytes = 512 * 1024 * 1024; // 전체 세션 합산 바이트
+};
+
+// 전체 세션 공용 송신 큐 메모리/드롭 카운터
+struct send_queue_stats {
+    std::atomic<std::size_t> queued_bytes{0};
+    std::atomic<std::uint64_t> dropped_oldest{0};
+    std::atomic<std::uint64_t> dropped_newest{0};
+    std::atomic<std::uint64_t> disconnects{0};
+};
+
+extern send_queue_stats g_send_queue_stats;
+
+// 접속 직후 자동으로 들어가는 방
+constexpr db::RoomId default_room_id = 1;
+// /history 한 번에 보내는 메시지 수
+constexpr std::size_t history_page_size = 50;
 
 class chat_session;
+class room_bus;
+
+using core_executors = std::vector<boost::asio::any_io_executor>;
+
+// ---- 방별 최근 메시지 ----
+// join 시 DB 조회 없이 재생한다. 이보다 오래된 기록은 DB 페이지 조회로.
+struct history_limits {
+    std::size_t max_messages = 100;     // 0 = 보관 안 함
+    std::size_t max_bytes = 256 * 1024; // line + frame 인코딩 합산
+};
+
+// 고정 용량 링 버퍼. 개수/바이트 한도를 넘으면 오래된 것부터 버린다.
+// 동기화는 호출자(chat_room) 책임.
+class message_ring {
+public:
+    explicit message_ring(const history_limits& limits);
+
+    void push(encoded_message_ptr msg);
+    // 오래된 순으로 out 에 추가
+    void snapshot(std::vector<encoded_message_ptr>& out) const;
+    std::size_t size() const { return count_; }
+    std::size_t capacity() const { return slots_.size(); }
+    std::size_t bytes() const { return bytes_; }
+
+private:
+    static std::size_t cost(const encoded_message& m) { return m.line.size() + m.frame.size(); }
+    void pop_front();
+
+    std::vector<encoded_message_ptr> slots_;
+    std::size_t max_bytes_;
+    std::size_t head_ = 0; // 가장 오래된 슬롯
+    std::size_t count_ = 0;
+    std::size_t bytes_ = 0;
+};
 
 class chat_room {
 public:
+    chat_room(db::RoomId id, const core_executors& cores, const history_limits& history);
+
+    db::RoomId id() const { return id_; }
     void join(std::shared_ptr<chat_session> session);
-    void leave(std::shared_ptr<chat_session> session);
+    void leave(const std::shared_ptr<chat_session>& session);
+    bool empty() const;
+    // 최근 메시지 링을 쓰는데 아직 아무 메시지도 안 들어왔는지 (재시작 직후, 처음 열린 방 등)
+    bool history_seedable();
+    // 빈 링을 공유 히스토리(오래된 순)로 한 번 채운다.
+    // 그 사이 라이브 메시지가 링에 들어왔으면 중복/역순이 되므로 채우지 않고 false
+    bool seed_history(const std::vector<encoded_message_ptr>& older);
     void deliver(const message& msg);
+    void deliver(const encoded_message_ptr& msg);
+
+private:
+    using member_list = std::vector<std::shared_ptr<chat_session>>;
+    // 세션이 소속된 코어별 멤버 목록 (shared 모드는 코어 1개)
+    using member_table = std::vector<member_list>;
+
+    db::RoomId id_;
+    const core_executors& cores_;
+    // copy-on-write 멤버 스냅샷. fan-out 은 락 없이 현재 스냅샷을 순회하고,
+    // join/leave 는 새 테이블을 만들어 교체하므로 진행 중인 fan-out 을 막지 않는다.
+    std::shared_ptr<const member_table> members_;
+    std::mutex mutex_; // join/leave 끼리만 직렬화
+
+    // 최근 메시지. deliver 의 push + 멤버 스냅샷과 join 의 멤버 추가 + 재생 스냅샷을
+    // 같은 락으로 묶어, 새 멤버가 메시지를 놓치거나 두 번 받지 않게 한다.
+    std::mutex history_mutex_;
+    message_ring history_;
+    // 라이브 메시지나 seed 가 한 번이라도 들어왔는지 (한도 초과로 링에 안 남은 것 포함)
+    bool history_started_ = false;
+};
+
+// RoomId → chat_room 레지스트리.
+// 방 id 해시로 샤드를 나눠 샤드별 mutex 만 잡으므로 전역 락이 없다.
+// 마지막 멤버가 나가면 방을 제거한다.
+class room_manager {
+public:
+    // cores: 코어(io_context)별 executor. 다른 코어 멤버에게는 코어당 메시지 1개만 post 한다.
+    explicit room_manager(core_executors cores, history_limits history = {});
+
+    std::shared_ptr<chat_room> join(db::RoomId id, std::shared_ptr<chat_session> session);
+    void leave(db::RoomId id, const std::shared_ptr<chat_session>& session);
+    std::shared_ptr<chat_room> find(db::RoomId id);
+
+    // 노드 간 브로드캐스트. 방이 열리고 닫힐 때 채널을 구독/해제한다.
+    // 세션이 생기기 전에만 설정할 것 (nullptr = 단일 노드)
+    void attach_bus(room_bus* bus) { bus_ = bus; }
+    room_bus* bus() const { return bus_; }
 
 private:
-    std::set<std::shared_ptr<chat_session>> sessions_;
-    std::mutex mutex_;
-    // 최근 메시지 보관하고 싶다면 deque 유지 가능
+    static constexpr std::size_t shard_count = 64;
+
+    struct shard {
+        std::mutex mutex;
+        std::unordered_map<db::RoomId, std::shared_ptr<chat_room>> rooms;
+    };
+
+    shard& shard_for(db::RoomId id) {
+        return shards_[std::hash<db::RoomId>{}(id) % shard_count];
+    }
+
+    core_executors cores_;
+    history_limits history_;
+    room_bus* bus_ = nullptr;
+    std::array<shard, shard_count> shards_;
 };
 
 class chat_session : public std::enable_shared_from_this<chat_session> {
 public:
-    explicit chat_session(tcp::socket socket, chat_room& room);
+    // executor: shared 모드는 세션 strand, per_core 모드는 소속 코어의 io_context executor
+    // (코어당 스레드 1개라 그 자체로 직렬화된다)
+    chat_session(tcp::socket socket, boost::asio::any_io_executor executor,
+                 room_manager& rooms, const send_queue_limits& limits, std::size_t core);
+    ~chat_session();
 
+    std::size_t core() const { return core_; }
     void start();
     void deliver(const message& msg);
+    void deliver(encoded_message_ptr msg);
 
 private:
+    // 첫 수신 바이트로 결정되는 세션 와이어 모드
+    enum class wire_mode { unknown, line, framed };
+
+    // 한 번의 gather write 에 묶을 최대 버퍼 수/바이트 (asio 의 iovec 상한과 맞춤)
+    static constexpr std::size_t max_write_buffers = 64;
+    static constexpr std::size_t max_write_bytes = 64 * 1024;
+
     void do_read();
     void do_write();
+    void enqueue(message_buffer buf);
+    bool over_limit(std::size_t incoming) const;
+    void close();
+    bool process_input();
+    bool process_lines();
+    bool process_frames();
+    void on_message(protocol::frame_type type, std::string_view payload);
+    void on_chat(std::string_view payload);
+    void on_login(std::string_view credentials); // "username password"
+    void on_history(std::string_view before);
+    // Redis/DB 에서 가져온 메시지(id 내림차순)를 오래된 순으로 보낸다.
+    // 그 사이 다른 방으로 옮겼으면 버린다.
+    void deliver_history(db::RoomId room_id, std::vector<db::Message> msgs);
+    // 로그인한 세션이 빈 링의 방에 있으면 Redis 히스토리로 링을 채우고 자신에게 재생한다
+    void warm_history();
+    void join_room(db::RoomId id);
+    void leave_room();
 
     tcp::socket socket_;
-    chat_room& room_;
-    boost::asio::streambuf buffer_;
+    room_manager& rooms_;
+    std::shared_ptr<chat_room> room_; // 현재 방 (strand 에서만 접근)
+    // 로그인 시 한 번 해석한 유저/샤드 정보. 이후 메시지마다 account DB 조회가 없다.
+    std::optional<UserLogin> login_;
+    bool login_pending_ = false;
+    protocol::read_buffer read_buf_;
+    wire_mode mode_ = wire_mode::unknown;
+    const send_queue_limits& limits_;
     message_queue write_msgs_;
-    boost::asio::strand<boost::asio::any_io_executor> strand_;
+    std::size_t queued_bytes_ = 0;   // write_msgs_ 전체 바이트 (전송 중 포함)
+    std::vector<boost::asio::const_buffer> write_bufs_;
+    std::size_t write_in_flight_ = 0; // write_msgs_ 앞쪽에서 전송 중인 개수
+    boost::asio::any_io_executor executor_;
+    std::size_t core_;
 };
 
 class chat_server {
 public:
-    chat_server(boost::asio::io_context& io, const tcp::endpoint& ep);
+    // per_core=true 면 SO_REUSEPORT 로 코어마다 acceptor 를 따로 열고,
+    // 받은 세션을 해당 코어 io_context 에 고정한다.
+    chat_server(boost::asio::io_context& io, const tcp::endpoint& ep,
+                room_manager& rooms, const send_queue_limits& limits,
+                std::size_t core = 0, bool per_core = false);
 
 private:
     void do_accept();
 
     tcp::acceptor acceptor_;
-    chat_room room_;
+    room_manager& rooms_;
+    const send_queue_limits& limits_;
+    std::size_t core_;
+    bool per_core_;
 };
@@ -1,65 +1,164 @@
 // src/db/AccountDb.cpp
 #include "AccountDb.h"
+#include "QueryLog.h"
 #include "SpdlogLoggerImpl.h"
 #include "models.h"
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
+#include <stdexcept>
 #include <soci/postgresql/soci-postgresql.h>
 
-AccountDb::AccountDb(const std::string &conninfo)
-    : sql_(soci::postgresql, conninfo) {
-  soci::logger slog(new SpdlogLoggerImpl());
-  sql_.set_logger(slog);
+AccountDb::AccountDb(const std::string &conninfo, const DbOptions &opts)
+    : pool_size_(opts.account_pool_size == 0 ? 1 : opts.account_pool_size),
+      pool_(pool_size_),
+      shard_pools_(opts.shard_pool_size, opts.shard_health_interval),
+      routing_(opts.routing) {
+  for (std::size_t i = 0; i < pool_size_; ++i) {
+    soci::session &sql = pool_.at(i);
+    sql.open(soci::postgresql, conninfo);
+    soci::logger slog(new SpdlogLoggerImpl());
+    sql.set_logger(slog);
+  }
+}
+
+std::unique_ptr<soci::session> AccountDb::checkout() {
+  auto start = std::chrono::steady_clock::now();
+  auto sql = std::make_unique<soci::session>(pool_);
+  auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+
+  stats_.checkouts.fetch_add(1, std::memory_order_relaxed);
+  stats_.wait_us_total.fetch_add(waited, std::memory_order_relaxed);
+  auto prev = stats_.wait_us_max.load(std::memory_order_relaxed);
+  while (static_cast<std::uint64_t>(waited) > prev &&
+         !stats_.wait_us_max.compare_exchange_weak(prev, waited)) {
+  }
+  if (waited > 50000) {
+    SPDLOG_WARN("AccountDb pool checkout waited {} us (pool size {})", waited,
+                pool_size_);
+  }
+
+  if (!sql->is_connected()) {
+    SPDLOG_WARN("AccountDb: pooled connection lost, reconnecting");
+    sql->reconnect();
+  }
+  return sql;
+}
+
+AccountDb::PoolStats AccountDb::poolStats() const {
+  PoolStats s;
+  s.checkouts = stats_.checkouts.load(std::memory_order_relaxed);
+  s.wait_us_total = stats_.wait_us_total.load(std::memory_order_relaxed);
+  s.wait_us_max = stats_.wait_us_max.load(std::memory_order_relaxed);
+  return s;
 }
 std::optional<db::User> AccountDb::getUser(const std::string &username) {
-  SPDLOG_INFO("getUser: {}", username);
+  QueryTimer timer("getUser");
+  SPDLOG_DEBUG("getUser: {}", username);
 
   db::User u;
   try {
-    sql_ << "SELECT id, username, shard_id, email, password_hash, created_at "
+    auto sql = checkout();
+    *sql << "SELECT id, username, shard_id, email, password_hash, created_at "
             "FROM users WHERE username = :name",
         soci::use(username, "name"), soci::into(u);
+    if (!sql->got_data()) {
+      SPDLOG_WARN("No user found for username={}", username);
+      return std::nullopt;
+    }
 
-    SPDLOG_INFO("User loaded: {}", u.username);
+    SPDLOG_DEBUG("User loaded: {}", u.username);
     return u;
   } catch (const soci::soci_error &e) {
     SPDLOG_ERROR("SOCI error: {}", e.what());
   }
-
-  SPDLOG_WARN("No user found for username={}", username);
   return std::nullopt;
 }
 
+bool AccountDb::checkPassword(const std::string &username,
+                              const std::string &password) {
+  QueryTimer timer("checkPassword");
+  try {
+    // password_hash 는 pgcrypto crypt() 형식 (예: crypt(pw, gen_salt('bf')))
+    int ok = 0;
+    auto sql = checkout();
+    *sql << "SELECT CASE WHEN password_hash = crypt(:pw, password_hash) "
+            "THEN 1 ELSE 0 END FROM users WHERE username = :name",
+        soci::use(password, "pw"), soci::use(username, "name"),
+        soci::into(ok);
+    return sql->got_data() && ok == 1;
+  } catch (const soci::soci_error &e) {
+    SPDLOG_ERROR("SOCI error: {}", e.what());
+    return false;
+  }
+}
+
 int AccountDb::getShardId(int user_id) {
+  if (auto cached = routing_.getUserShard(user_id))
+    return *cached;
+
+  QueryTimer timer("getShardId");
   int shard_id = -1;
-  sql_ << "SELECT shard_id FROM users WHERE id = :id", soci::use(user_id, "id"),
+  auto sql = checkout();
+  *sql << "SELECT shard_id FROM users WHERE id = :id", soci::use(user_id, "id"),
       soci::into(shard_id);
+  if (shard_id >= 0)
+    routing_.putUserShard(user_id, shard_id);
   return shard_id;
 }
 
 std::optional<db::ShardInfo> AccountDb::getShardInfo(int shard_id) {
-  SPDLOG_INFO("shard_id: {}", shard_id);
+  if (auto cached = routing_.getShardInfo(shard_id))
+    return cached;
+
+  QueryTimer timer("getShardInfo");
+  SPDLOG_DEBUG("shard_id: {}", shard_id);
 
   db::ShardInfo s;
   try {
-    soci::indicator ind;
-    sql_ << "SELECT id, name, conninfo, created_at FROM shards WHERE id = :id",
+    auto sql = checkout();
+    *sql << "SELECT id, name, conninfo, created_at FROM shards WHERE id = :id",
         soci::use(shard_id, "id"), soci::into(s);
-    // SPDLOG_INFO("Shard: {}", s.conninfo );
+    // 없는 샤드는 캐시하지 않는다 (빈 conninfo 가 TTL 동안 남지 않도록)
+    if (!sql->got_data()) {
+      SPDLOG_WARN("No Shard found for shard_id={}", shard_id);
+      return std::nullopt;
+    }
+    routing_.putShardInfo(s);
     return s;
   } catch (const soci::soci_error &e) {
     SPDLOG_ERROR("SOCI error: {}", e.what());
   }
-
-  SPDLOG_WARN("No Shard found for shard_id={}", shard_id);
   return std::nullopt;
 }
 
+std::vector<db::ShardInfo> AccountDb::getShards() {
+  QueryTimer timer("getShards");
+  std::vector<db::ShardInfo> out;
+  try {
+    auto sql = checkout();
+    soci::rowset<db::ShardInfo> rs =
+        (sql->prepare << "SELECT id, name, conninfo, created_at FROM shards "
+                         "ORDER BY id");
+    for (auto &s : rs) {
+      routing_.putShardInfo(s);
+      out.push_back(s);
+    }
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("getShards error: {}", e.what());
+    out.clear();
+  }
+  return out;
+}
+
 std::optional<db::User> AccountDb::createUser(const std::string &username,
                                               const std::string &password_hash,
                                               std::optional<std::string> email,
                                               int shard_id) {
+  QueryTimer timer("createUser");
   SPDLOG_INFO("createUser: username={}, shard_id={}", username, shard_id);
 
   db::User u;
@@ -71,7 +170,8 @@ std::optional<db::User> AccountDb::createUser(const std::string &username,
       emailInd = soci::i_ok;
     }
 
-    sql_
+    auto sql = checkout();
+    *sql
         << "INSERT INTO users(username, shard_id, email, password_hash) "
            "VALUES(:u, :s, :e, :p) "
            "RETURNING id, username, shard_id, email, password_hash, created_at",
@@ -80,6 +180,9 @@ std::optional<db::User> AccountDb::createUser(const std::string &username,
         soci::into(u);
 
     SPDLOG_INFO("User created: id={}, username={}", u.id, u.username);
+    // 이전 매핑이 남아있을 수 있으므로 무효화 후 새 매핑으로 채운다
+    routing_.invalidateUser(u.id);
+    routing_.putUserShard(u.id, u.shard_id);
     return u;
   } catch (const soci::soci_error &e) {
     SPDLOG_ERROR("createUser failed: {}", e.what());
@@ -87,15 +190,27 @@ std::optional<db::User> AccountDb::createUser(const std::string &username,
   }
 }
 
+void AccountDb::invalidateUserRouting(int user_id) {
+  routing_.invalidateUser(user_id);
+}
+
+void AccountDb::invalidateShardRouting(int shard_id) {
+  routing_.invalidateShard(shard_id);
+}
+
 std::optional<db::ShardInfo>
 AccountDb::getShardForUser(const std::string &username) {
-  SPDLOG_INFO("getShardForUser: {}", username);
+  QueryTimer timer("getShardForUser");
+  SPDLOG_DEBUG("getShardForUser: {}", username);
   db::ShardInfo s;
   try {
-    sql_ << "SELECT s.id, s.name, s.conninfo, s.created_at "
+    auto sql = checkout();
+    *sql << "SELECT s.id, s.name, s.conninfo, s.created_at "
             "FROM users u JOIN shards s ON s.id = u.shard_id "
             "WHERE u.username = :name",
         soci::use(username, "name"), soci::into(s);
+    if (!sql->got_data())
+      return std::nullopt;
     return s;
   } catch (const soci::soci_error &e) {
     SPDLOG_ERROR("getShardForUser error: {}", e.what());
@@ -118,13 +233,13 @@ bool AccountDb::withUserShardSession(
       return false;
     }
 
-    SPDLOG_INFO("withUserShardSession: connecting to shard {} ({}).", shard->id,
-                shard->name);
-    soci::session shard_sql(soci::postgresql, shard->conninfo);
-    soci::logger slog(new SpdlogLoggerImpl());
-    shard_sql.set_logger(slog);
+    auto shard_db = shard_pools_.acquire(*shard);
+    if (!shard_db) {
+      SPDLOG_WARN("withUserShardSession: shard {} unavailable", shard_id);
+      return false;
+    }
 
-    fn(shard_sql);
+    fn(shard_db->session());
     return true;
   } catch (const std::exception &e) {
     SPDLOG_ERROR("withUserShardSession error: {}", e.what());
@@ -133,16 +248,38 @@ bool AccountDb::withUserShardSession(
 }
 
 // TCC Implementation
+// tx id 는 INSERT 에서 DB 가 만든다 (gen_random_uuid). 재시작/여러 노드에서도 겹치지 않는다
+static std::string insertTransaction(soci::session &sql) {
+  int status = (int)db::TransactionStatus::PENDING;
+  std::string tx_id;
+  sql << "INSERT INTO transactions(id, status, created_at) "
+         "VALUES('TX_' || gen_random_uuid(), :st, NOW()) RETURNING id",
+      soci::use(status), soci::into(tx_id);
+  if (!sql.got_data())
+    throw std::runtime_error("insert transactions returned no id");
+  return tx_id;
+}
+
+// PostgreSQL 배열 리터럴 (정수 필드). 값은 바인딩 파라미터로 넘긴다.
+template <typename T>
+static std::string toArrayLiteral(const std::vector<db::TransactionPart> &parts,
+                                  T db::TransactionPart::*field) {
+  std::string out = "{";
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    if (i)
+      out += ',';
+    out += std::to_string(static_cast<int>(parts[i].*field));
+  }
+  out += '}';
+  return out;
+}
+
 std::string AccountDb::startTransaction() {
-  // Generate simple ID
-  std::string tx_id =
-      "TX_" + std::to_string(std::time(nullptr)) + "_" + std::to_string(rand());
+  QueryTimer timer("startTransaction");
 
   try {
-    int status = (int)db::TransactionStatus::PENDING;
-    sql_ << "INSERT INTO transactions(id, status, created_at) VALUES(:id, :st, "
-            "NOW())",
-        soci::use(tx_id), soci::use(status);
+    auto sql = checkout();
+    std::string tx_id = insertTransaction(*sql);
     SPDLOG_INFO("Transaction started: {}", tx_id);
     return tx_id;
   } catch (const std::exception &e) {
@@ -151,11 +288,70 @@ std::string AccountDb::startTransaction() {
   }
 }
 
+// 참여자는 multi-row INSERT 한 번. part_no 는 입력 순서
+static void insertTransactionParts(soci::session &sql, const std::string &tx_id,
+                                   const std::vector<db::TransactionPart> &parts) {
+  auto numbered = parts;
+  for (std::size_t i = 0; i < numbered.size(); ++i)
+    numbered[i].part_no = static_cast<int>(i);
+  std::string part_nos = toArrayLiteral(numbered, &db::TransactionPart::part_no);
+  std::string shards = toArrayLiteral(numbered, &db::TransactionPart::shard_id);
+  std::string users = toArrayLiteral(numbered, &db::TransactionPart::user_id);
+  std::string amounts = toArrayLiteral(numbered, &db::TransactionPart::amount);
+  std::string deducts =
+      toArrayLiteral(numbered, &db::TransactionPart::is_deduct);
+
+  sql << "INSERT INTO transaction_parts"
+         "(tx_id, part_no, shard_id, user_id, amount, is_deduct) "
+         "SELECT :id, * FROM unnest(CAST(:p AS int[]), CAST(:s AS int[]), "
+         "CAST(:u AS int[]), CAST(:a AS int[]), CAST(:d AS int[]))",
+      soci::use(tx_id), soci::use(part_nos), soci::use(shards),
+      soci::use(users), soci::use(amounts), soci::use(deducts);
+}
+
+std::string
+AccountDb::startTransaction(const std::vector<db::TransactionPart> &parts) {
+  QueryTimer timer("startTransaction");
+
+  try {
+    auto sql = checkout();
+    soci::transaction tr(*sql);
+    std::string tx_id = insertTransaction(*sql);
+    insertTransactionParts(*sql, tx_id, parts);
+    tr.commit();
+    SPDLOG_DEBUG("Transaction started: {} parts={}", tx_id, parts.size());
+    return tx_id;
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("startTransaction failed: {}", e.what());
+    return "";
+  }
+}
+
+// from → to 조건부 전이. 전이 후(또는 이미 진행된) 상태를 돌려준다 (없으면 -1)
+static int transitionTransaction(soci::session &sql, const std::string &tx_id,
+                                 db::TransactionStatus from,
+                                 db::TransactionStatus to) {
+  int f = (int)from, t = (int)to;
+  int status = -1;
+  soci::indicator ind = soci::i_null;
+  sql << "UPDATE transactions SET status = CASE WHEN status = :f THEN :t "
+         "ELSE status END WHERE id = :id RETURNING status",
+      soci::use(f), soci::use(t), soci::use(tx_id), soci::into(status, ind);
+  return sql.got_data() && ind == soci::i_ok ? status : -1;
+}
+
 bool AccountDb::commitTransaction(const std::string &tx_id) {
+  QueryTimer timer("commitTransaction");
   try {
-    int status = (int)db::TransactionStatus::CONFIRMED;
-    sql_ << "UPDATE transactions SET status = :st WHERE id = :id",
-        soci::use(status), soci::use(tx_id);
+    auto sql = checkout();
+    int status = transitionTransaction(*sql, tx_id,
+                                       db::TransactionStatus::PENDING,
+                                       db::TransactionStatus::CONFIRMED);
+    if (status != (int)db::TransactionStatus::CONFIRMED &&
+        status != (int)db::TransactionStatus::COMMITTED) {
+      SPDLOG_WARN("commitTransaction: {} is in status {}", tx_id, status);
+      return false;
+    }
     SPDLOG_INFO("Transaction confirmed: {}", tx_id);
     return true;
   } catch (const std::exception &e) {
@@ -164,15 +360,109 @@ bool AccountDb::commitTransaction(const std::string &tx_id) {
   }
 }
 
+bool AccountDb::commitTransaction(
+    const std::string &tx_id, const std::vector<db::TransactionPart> &parts) {
+  QueryTimer timer("commitTransaction");
+  try {
+    auto sql = checkout();
+    soci::transaction tr(*sql);
+    int status = transitionTransaction(*sql, tx_id,
+                                       db::TransactionStatus::PENDING,
+                                       db::TransactionStatus::CONFIRMED);
+    if (status != (int)db::TransactionStatus::CONFIRMED) {
+      tr.rollback();
+      if (status == (int)db::TransactionStatus::COMMITTED)
+        return true;
+      SPDLOG_WARN("commitTransaction: {} is in status {}", tx_id, status);
+      return false;
+    }
+    // 복구가 최종 참여자 기준으로 confirm 하도록 결정과 같은 트랜잭션에서 교체
+    *sql << "DELETE FROM transaction_parts WHERE tx_id = :id", soci::use(tx_id);
+    insertTransactionParts(*sql, tx_id, parts);
+    tr.commit();
+    SPDLOG_INFO("Transaction confirmed: {} parts={}", tx_id, parts.size());
+    return true;
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("commitTransaction failed: {}: {}", tx_id, e.what());
+    return false;
+  }
+}
+
 bool AccountDb::cancelTransaction(const std::string &tx_id) {
+  QueryTimer timer("cancelTransaction");
   try {
-    int status = (int)db::TransactionStatus::CANCELED;
-    sql_ << "UPDATE transactions SET status = :st WHERE id = :id",
-        soci::use(status), soci::use(tx_id);
+    auto sql = checkout();
+    int status = transitionTransaction(*sql, tx_id,
+                                       db::TransactionStatus::PENDING,
+                                       db::TransactionStatus::CANCELED);
+    if (status != (int)db::TransactionStatus::CANCELED &&
+        status != (int)db::TransactionStatus::ROLLED_BACK) {
+      SPDLOG_WARN("cancelTransaction: {} is in status {}", tx_id, status);
+      return false;
+    }
     SPDLOG_INFO("Transaction canceled: {}", tx_id);
     return true;
   } catch (const std::exception &e) {
     SPDLOG_ERROR("cancelTransaction failed: {}", tx_id);
     return false;
   }
+}
+
+bool AccountDb::finishTransaction(const std::string &tx_id,
+                                  db::TransactionStatus status) {
+  QueryTimer timer("finishTransaction");
+  // 결정 상태에서만 완료로 (CONFIRMED → COMMITTED, CANCELED → ROLLED_BACK)
+  auto from = status == db::TransactionStatus::COMMITTED
+                  ? db::TransactionStatus::CONFIRMED
+                  : db::TransactionStatus::CANCELED;
+  try {
+    auto sql = checkout();
+    return transitionTransaction(*sql, tx_id, from, status) == (int)status;
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("finishTransaction failed: {}: {}", tx_id, e.what());
+    return false;
+  }
+}
+
+std::vector<db::Transaction>
+AccountDb::getUnfinishedTransactions(std::chrono::seconds older_than,
+                                     std::size_t limit) {
+  QueryTimer timer("getUnfinishedTransactions");
+  std::vector<db::Transaction> out;
+  try {
+    int secs = static_cast<int>(older_than.count());
+    int n = static_cast<int>(limit);
+    auto sql = checkout();
+    soci::rowset<db::Transaction> rs =
+        (sql->prepare << "SELECT id, status, created_at FROM transactions "
+                         "WHERE status IN (0, 1, 2) "
+                         "AND created_at < NOW() - make_interval(secs => :s) "
+                         "ORDER BY created_at LIMIT :n",
+         soci::use(secs), soci::use(n));
+    for (auto &t : rs)
+      out.push_back(t);
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("getUnfinishedTransactions error: {}", e.what());
+  }
+  return out;
+}
+
+std::optional<std::vector<db::TransactionPart>>
+AccountDb::getTransactionParts(const std::string &tx_id) {
+  QueryTimer timer("getTransactionParts");
+  std::vector<db::TransactionPart> out;
+  try {
+    auto sql = checkout();
+    soci::rowset<db::TransactionPart> rs =
+        (sql->prepare << "SELECT tx_id, part_no, shard_id, user_id, amount, "
+                         "is_deduct FROM transaction_parts "
+                         "WHERE tx_id = :id ORDER BY part_no",
+         soci::use(tx_id));
+    for (auto &p : rs)
+      out.push_back(p);
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("getTransactionParts error: {}", e.what());
+    return std::nullopt;
+  }
+  return out;
 }
\ No newline at end of file
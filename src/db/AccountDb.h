@@ -1,17 +1,45 @@
 // src/db/AccountDb.h
 #pragma once
+#include "DbOptions.h"
+#include "RoutingCache.h"
+#include "ShardPools.h"
 #include "models.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <soci/soci.h>
 #include <string>
+#include <vector>
 
+// account_db 접근. 호출마다 커넥션 풀(opts.account_pool_size)에서 세션을 빌려
+// 쓰므로 여러 스레드에서 동시에 호출해도 안전하다.
 class AccountDb {
 public:
-  explicit AccountDb(const std::string &conninfo);
+  explicit AccountDb(const std::string &conninfo, const DbOptions &opts = {});
 
+  // 풀 체크아웃 대기 통계
+  struct PoolStats {
+    std::uint64_t checkouts = 0;
+    std::uint64_t wait_us_total = 0;
+    std::uint64_t wait_us_max = 0;
+  };
+  PoolStats poolStats() const;
+
+  // 없으면 nullopt
   std::optional<db::User> getUser(const std::string &username);
+  // password 를 password_hash(pgcrypto crypt 형식)와 DB 에서 비교
+  bool checkPassword(const std::string &username, const std::string &password);
+  // 라우팅 캐시 우선, miss 일 때만 account DB 조회
   int getShardId(int user_id);
   std::optional<db::ShardInfo> getShardInfo(int shard_id);
+  // shards 테이블 전체 (id 순). 조회 실패면 빈 벡터
+  std::vector<db::ShardInfo> getShards();
+
+  // 샤드 이전 등으로 매핑이 바뀌었을 때 호출
+  void invalidateUserRouting(int user_id);
+  void invalidateShardRouting(int shard_id);
 
   // 신규 유저 생성 (username 고유, email NULL 가능). 성공 시 생성된 전체 레코드
   // 반환
@@ -23,18 +51,49 @@ public:
   // username으로 샤드 정보 조회 (users → shards join)
   std::optional<db::ShardInfo> getShardForUser(const std::string &username);
 
-  // user_id 기준으로 해당 샤드 세션을 열어 콜백 실행 (샤드 conninfo 사용)
-  // 콜백 내부에서 쿼리 실행. 세션은 함수 호출 동안만 유효.
-  // user_id 기준으로 해당 샤드 세션을 열어 콜백 실행 (샤드 conninfo 사용)
+  // user_id 기준으로 해당 샤드 풀에서 세션을 빌려 콜백 실행
   // 콜백 내부에서 쿼리 실행. 세션은 함수 호출 동안만 유효.
   bool withUserShardSession(int user_id,
                             const std::function<void(soci::session &)> &fn);
 
   // TCC Transaction Coordinator
   std::string startTransaction();
+  // 참여자(transaction_parts)와 함께 한 트랜잭션으로 기록 (parts 의 tx_id 는 무시)
+  std::string startTransaction(const std::vector<db::TransactionPart> &parts);
+  // PENDING 일 때만 CONFIRMED 로 바꾼다. 이미 CONFIRMED/COMMITTED 면 true,
+  // 복구 쪽에서 먼저 취소했으면 false
   bool commitTransaction(const std::string &tx_id);
+  // 위와 같고, 참여자를 parts 로 바꿔 기록한다 (Try 결과로 일부가 빠진 배치)
+  bool commitTransaction(const std::string &tx_id,
+                         const std::vector<db::TransactionPart> &parts);
+  // PENDING 일 때만 CANCELED 로 바꾼다. 이미 CANCELED/ROLLED_BACK 이면 true
   bool cancelTransaction(const std::string &tx_id);
+  // 모든 샤드 처리 후 COMMITTED / ROLLED_BACK 으로
+  bool finishTransaction(const std::string &tx_id,
+                         db::TransactionStatus status);
+  // older_than 보다 오래된 미완료(PENDING/CONFIRMED/CANCELED) 트랜잭션
+  std::vector<db::Transaction>
+  getUnfinishedTransactions(std::chrono::seconds older_than, std::size_t limit);
+  // 조회 실패 시 nullopt (참여자 없음과 구분)
+  std::optional<std::vector<db::TransactionPart>>
+  getTransactionParts(const std::string &tx_id);
+
+  // 샤드별 커넥션 풀 (shards 테이블 기준)
+  ShardPools &shardPools() { return shard_pools_; }
 
 private:
-  soci::session sql_;
+  // 풀에서 세션을 빌린다 (반환값 파괴 시 반납). 대기 시간을 통계에 기록.
+  std::unique_ptr<soci::session> checkout();
+
+  struct AtomicPoolStats {
+    std::atomic<std::uint64_t> checkouts{0};
+    std::atomic<std::uint64_t> wait_us_total{0};
+    std::atomic<std::uint64_t> wait_us_max{0};
+  };
+
+  std::size_t pool_size_;
+  soci::connection_pool pool_;
+  AtomicPoolStats stats_;
+  ShardPools shard_pools_;
+  RoutingCache routing_;
 };
\ No newline at end of file
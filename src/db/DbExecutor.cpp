@@ -0,0 +1,68 @@
+// src/db/DbExecutor.cpp
+#include "DbExecutor.h"
+#include <spdlog/spdlog.h>
+
+DbExecutor::DbExecutor(std::size_t threads) {
+  if (threads == 0)
+    threads = 1;
+  workers_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (auto &w : workers_) {
+    Worker *worker = w.get();
+    worker->thread = std::thread([this, worker] { run(*worker); });
+  }
+}
+
+DbExecutor::~DbExecutor() { stop(); }
+
+void DbExecutor::post(Task task) {
+  post(next_.fetch_add(1, std::memory_order_relaxed), std::move(task));
+}
+
+void DbExecutor::post(std::size_t key, Task task) {
+  Worker &w = *workers_[key % workers_.size()];
+  {
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.stopping) {
+      SPDLOG_WARN("DbExecutor stopped, task dropped");
+      return;
+    }
+    w.tasks.push_back(std::move(task));
+  }
+  w.cv.notify_one();
+}
+
+void DbExecutor::stop() {
+  for (auto &w : workers_) {
+    {
+      std::lock_guard<std::mutex> lock(w->mutex);
+      w->stopping = true;
+    }
+    w->cv.notify_one();
+  }
+  for (auto &w : workers_) {
+    if (w->thread.joinable())
+      w->thread.join();
+  }
+}
+
+void DbExecutor::run(Worker &w) {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(w.mutex);
+      w.cv.wait(lock, [&] { return w.stopping || !w.tasks.empty(); });
+      if (w.tasks.empty())
+        return; // stopping 이고 남은 작업 없음
+      task = std::move(w.tasks.front());
+      w.tasks.pop_front();
+    }
+    try {
+      task();
+    } catch (const std::exception &e) {
+      SPDLOG_ERROR("DbExecutor task error: {}", e.what());
+    }
+  }
+}
@@ -0,0 +1,49 @@
+// src/db/DbExecutor.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// DB 전용 워커 스레드 풀.
+// io(reactor) 스레드가 SOCI 호출로 블록되지 않도록 DB 작업은 모두 여기서 실행한다.
+// 같은 key 로 넘긴 작업은 같은 워커에서 들어온 순서대로 실행된다.
+class DbExecutor {
+public:
+  using Task = std::function<void()>;
+
+  explicit DbExecutor(std::size_t threads);
+  ~DbExecutor();
+
+  DbExecutor(const DbExecutor &) = delete;
+  DbExecutor &operator=(const DbExecutor &) = delete;
+
+  // 순서 보장이 필요 없는 작업 (워커 round-robin)
+  void post(Task task);
+  // key 별 순서 보장 (예: room_id, user_id)
+  void post(std::size_t key, Task task);
+
+  // 남은 작업을 모두 처리한 뒤 워커 종료
+  void stop();
+
+  std::size_t size() const { return workers_.size(); }
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Task> tasks;
+    bool stopping = false;
+    std::thread thread;
+  };
+
+  void run(Worker &w);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<std::size_t> next_{0};
+};
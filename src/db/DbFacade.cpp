@@ -1,13 +1,124 @@
 // src/db/DbFacade.cpp
 #include "DbFacade.h"
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <spdlog/spdlog.h>
 
-DbFacade::DbFacade(const std::string &account_conninfo)
-    : router_(account_conninfo) {}
+DbFacade::DbFacade(const std::string &account_conninfo, const DbOptions &opts)
+    : router_(account_conninfo, opts), tcc_(router_, opts.tcc),
+      transfers_(tcc_, opts.transfer_batch),
+      executor_(opts.executor_threads), fanout_(opts.fanout_threads) {}
+
+void DbFacade::findUserAsync(std::string username, UserCallback done) {
+  auto key = std::hash<std::string>{}(username);
+  executor_.post(key, [this, username = std::move(username),
+                       done = std::move(done)] { done(findUser(username)); });
+}
+
+void DbFacade::loginAsync(std::string username, std::string password,
+                          LoginCallback done) {
+  auto key = std::hash<std::string>{}(username);
+  executor_.post(key, [this, username = std::move(username),
+                       password = std::move(password),
+                       done = std::move(done)] {
+    auto user = findUser(username);
+    if (!user) {
+      done(std::nullopt);
+      return;
+    }
+    // 캐시된 User 의 hash 가 아니라 DB 의 현재 값으로 확인한다
+    if (!router_.getAccountDb()->checkPassword(username, password)) {
+      SPDLOG_WARN("loginAsync: bad password for {}", username);
+      done(std::nullopt);
+      return;
+    }
+    auto info = router_.getAccountDb()->getShardInfo(user->shard_id);
+    if (!info) {
+      SPDLOG_WARN("loginAsync: shard {} not found for {}", user->shard_id,
+                  username);
+      done(std::nullopt);
+      return;
+    }
+    UserLogin login;
+    login.shard_id = info->id;
+    login.writer = router_.getMessageWriterForShard(*info);
+    login.user = std::move(*user);
+    if (!login.writer) {
+      done(std::nullopt);
+      return;
+    }
+    done(std::move(login));
+  });
+}
+
+void DbFacade::saveMessageAsync(const UserLogin &login, long long room_id,
+                                std::string content, SaveCallback done) {
+  login.writer->enqueue(room_id, login.user.id, std::move(content),
+                        std::move(done));
+}
+
+void DbFacade::saveMessageAsync(int user_id, long long room_id,
+                                std::string content, SaveCallback done) {
+  executor_.post(static_cast<std::size_t>(room_id),
+                 [this, user_id, room_id, content = std::move(content),
+                  done = std::move(done)]() mutable {
+                   auto writer = router_.getMessageWriter(user_id);
+                   if (!writer) {
+                     if (done) {
+                       db::Message failed;
+                       failed.room_id = room_id;
+                       failed.user_id = user_id;
+                       done(false, failed);
+                     }
+                     return;
+                   }
+                   writer->enqueue(room_id, user_id, std::move(content),
+                                   std::move(done));
+                 });
+}
+
+void DbFacade::loadMessagesAsync(int user_id, long long room_id,
+                                 MessagesCallback done) {
+  executor_.post(static_cast<std::size_t>(room_id),
+                 [this, user_id, room_id, done = std::move(done)] {
+                   done(loadMessages(user_id, room_id));
+                 });
+}
+
+void DbFacade::loadMessagesAsync(int user_id, long long room_id,
+                                 db::MessageId before_id, std::size_t limit,
+                                 MessagesCallback done) {
+  executor_.post(static_cast<std::size_t>(room_id),
+                 [this, user_id, room_id, before_id, limit,
+                  done = std::move(done)] {
+                   done(loadMessages(user_id, room_id, before_id, limit));
+                 });
+}
 
 std::optional<db::User> DbFacade::findUser(const std::string &username) {
-  return router_.getUser(username);
+  if (!user_lookup_)
+    return router_.getUser(username);
+  // 캐시(L1/Redis)에는 자격 증명을 두지 않는다. 비밀번호 확인은 항상 DB 에서
+  return user_lookup_(username, [this, username] {
+    auto user = router_.getUser(username);
+    if (user)
+      user->password_hash.clear();
+    return user;
+  });
+}
+
+void DbFacade::setUserCache(UserLookup lookup, UserInvalidate invalidate) {
+  user_lookup_ = std::move(lookup);
+  user_invalidate_ = std::move(invalidate);
+}
+
+void DbFacade::invalidateUser(const std::string &username) {
+  if (user_invalidate_)
+    user_invalidate_(username);
 }
 std::optional<db::User> DbFacade::createUser(const std::string &username,
                                              const std::string &password_hash,
@@ -19,7 +130,16 @@ std::optional<db::User> DbFacade::createUser(const std::string &username,
   if (!accountDb) {
     return std::nullopt;
   }
-  return accountDb->createUser(username, password_hash, email, shard_id);
+  auto user = accountDb->createUser(username, password_hash, email, shard_id);
+  // 같은 이름으로 남아 있던 캐시 항목이 새 계정을 가리지 않도록
+  if (user)
+    invalidateUser(username);
+  return user;
+}
+
+void DbFacade::invalidateUserRouting(int user_id, const std::string &username) {
+  router_.getAccountDb()->invalidateUserRouting(user_id);
+  invalidateUser(username);
 }
 
 bool DbFacade::saveMessage(int user_id, long long room_id,
@@ -33,14 +153,135 @@ bool DbFacade::saveMessage(int user_id, long long room_id,
 std::vector<db::Message> DbFacade::loadMessages(int user_id,
                                                 long long room_id) {
   auto shard = router_.getShardForUser(user_id);
+  if (!shard)
+    return {};
   return shard->getMessages(room_id);
 }
 
+std::vector<db::Message> DbFacade::loadMessages(int user_id, long long room_id,
+                                                db::MessageId before_id,
+                                                std::size_t limit) {
+  auto shard = router_.getShardForUser(user_id);
+  if (!shard)
+    return {};
+  return shard->getMessagesPage(room_id, before_id, limit);
+}
+
+std::vector<db::Message>
+DbFacade::loadRoomMessages(long long room_id, const db::MessageCursor &before,
+                           std::size_t limit) {
+  limit = std::min(limit, ShardDb::max_page_size);
+  auto shards = router_.getShards();
+  if (shards.empty() || limit == 0)
+    return {};
+
+  // 커서의 (created_us, shard_id, id) 비교를 샤드별 (created_at, id) 키로 바꾼다.
+  // 같은 created_at 이면 커서보다 작은 샤드는 전부, 큰 샤드는 하나도 포함되지 않는다
+  auto pageOf = [this, room_id, &before, limit](const db::ShardInfo &info) {
+    std::vector<db::Message> msgs;
+    try {
+      auto shard = router_.getShard(info.id);
+      if (!shard) {
+        SPDLOG_WARN("loadRoomMessages: shard {} unavailable", info.id);
+        return msgs;
+      }
+      db::MessageId key = before.id;
+      if (info.id < before.shard_id)
+        key = std::numeric_limits<db::MessageId>::max();
+      else if (info.id > before.shard_id)
+        key = 0;
+      msgs = shard->getMessagesBefore(room_id, before.created_us, key, limit);
+      for (auto &m : msgs)
+        m.shard_id = info.id;
+    } catch (const std::exception &e) {
+      SPDLOG_ERROR("loadRoomMessages: shard {} failed: {}", info.id, e.what());
+      msgs.clear();
+    }
+    return msgs;
+  };
+  // 첫 샤드는 호출 스레드에서, 나머지는 fanout_ 워커에서 (샤드 id 별로 같은 워커).
+  // 모든 future 를 기다린 뒤 반환하므로 pageOf/shards 참조는 안전하다
+  std::vector<std::future<std::vector<db::Message>>> others;
+  for (std::size_t i = 1; i < shards.size(); ++i) {
+    auto page = std::make_shared<std::promise<std::vector<db::Message>>>();
+    others.push_back(page->get_future());
+    const auto &info = shards[i];
+    fanout_.post(static_cast<std::size_t>(info.id),
+                 [page, &pageOf, &info] { page->set_value(pageOf(info)); });
+  }
+  auto msgs = pageOf(shards[0]);
+  for (auto &f : others) {
+    std::vector<db::Message> page;
+    try {
+      page = f.get();
+    } catch (const std::future_error &e) { // 종료 중 fanout_ 이 작업을 버린 경우
+      SPDLOG_WARN("loadRoomMessages: shard page dropped: {}", e.what());
+    }
+    msgs.insert(msgs.end(), std::make_move_iterator(page.begin()),
+                std::make_move_iterator(page.end()));
+  }
+
+  std::sort(msgs.begin(), msgs.end(),
+            [](const db::Message &a, const db::Message &b) {
+              return db::cursorOf(b) < db::cursorOf(a);
+            });
+  if (msgs.size() > limit)
+    msgs.resize(limit);
+  return msgs;
+}
+
+bool DbFacade::streamMessages(int user_id, long long room_id,
+                              db::MessageId after_id, std::size_t batch_size,
+                              const ShardDb::BatchCallback &on_batch) {
+  auto shard = router_.getShardForUser(user_id);
+  if (!shard)
+    return false;
+  return shard->streamMessages(room_id, after_id, batch_size, on_batch);
+}
+
 // TCC Orchestration
+void DbFacade::transferMoneyAsync(std::string from_username,
+                                  std::string to_username, int amount,
+                                  TransferCallback done) {
+  auto key = std::hash<std::string>{}(from_username);
+  executor_.post(key, [this, from_username = std::move(from_username),
+                       to_username = std::move(to_username), amount,
+                       done = std::move(done)]() mutable {
+    auto fail = [&] {
+      if (done)
+        done(TccCoordinator::Outcome::Canceled);
+    };
+    if (amount <= 0 || from_username == to_username) {
+      SPDLOG_WARN("transferMoneyAsync: invalid request");
+      fail();
+      return;
+    }
+    auto fromUser = findUser(from_username);
+    auto toUser = findUser(to_username);
+    if (!fromUser || !toUser) {
+      SPDLOG_WARN("transferMoneyAsync: user not found {} -> {}", from_username,
+                  to_username);
+      fail();
+      return;
+    }
+    TransferBatcher::Transfer transfer;
+    transfer.from_user_id = fromUser->id;
+    transfer.from_shard = fromUser->shard_id;
+    transfer.to_user_id = toUser->id;
+    transfer.to_shard = toUser->shard_id;
+    transfer.amount = amount;
+    transfers_.enqueue(transfer, std::move(done));
+  });
+}
+
 bool DbFacade::transferMoney(const std::string &from_username,
                              const std::string &to_username, int amount) {
   SPDLOG_INFO("transferMoney: {} -> {}, amount={}", from_username, to_username,
               amount);
+  if (amount <= 0 || from_username == to_username) {
+    SPDLOG_WARN("transferMoney: invalid request");
+    return false;
+  }
 
   auto fromUser = findUser(from_username);
   auto toUser = findUser(to_username);
@@ -54,56 +295,27 @@ bool DbFacade::transferMoney(const std::string &from_username,
     return false;
   }
 
-  // 1. Start Global Transaction (Coordinator)
-  auto accountDb = router_.getAccountDb();
-  std::string tx_id = accountDb->startTransaction();
-  if (tx_id.empty()) {
-    SPDLOG_ERROR("transferMoney: Failed to start transaction");
-    return false;
+  // 같은 샤드: 로컬 트랜잭션 한 번 (TCC 없음)
+  if (fromUser->shard_id == toUser->shard_id) {
+    auto shard = router_.getShard(fromUser->shard_id);
+    if (!shard) {
+      SPDLOG_ERROR("transferMoney: Failed to connect to shard {}",
+                   fromUser->shard_id);
+      return false;
+    }
+    return shard->transferLocal(fromUser->id, toUser->id, amount);
   }
 
-  auto shardA = router_.getShardForUser(fromUser->id);
-  auto shardB = router_.getShardForUser(toUser->id);
-
-  if (!shardA || !shardB) {
-    SPDLOG_ERROR("transferMoney: Failed to connect to shards");
-    accountDb->cancelTransaction(tx_id);
-    return false;
-  }
-
-  // 2. Try Phase (Prepare)
-  // 2-1. Reserve from Sender
-  bool resA = shardA->prepareTransfer(fromUser->id, amount, true, tx_id);
-  if (!resA) {
-    SPDLOG_WARN("transferMoney: Sender prepare failed");
-    accountDb->cancelTransaction(tx_id);
-    return false;
-  }
-
-  // 2-2. Check Receiver
-  bool resB = shardB->prepareTransfer(toUser->id, amount, false, tx_id);
-  if (!resB) {
-    SPDLOG_WARN("transferMoney: Receiver prepare failed");
-    // Rollback Sender
-    shardA->rollbackTransfer(fromUser->id, amount, true, tx_id);
-    accountDb->cancelTransaction(tx_id);
-    return false;
-  }
-
-  // 3. Confirm Phase (Commit)
-  // 3-1. Mark Global Tx CONFIRMED
-  bool commitMeta = accountDb->commitTransaction(tx_id);
-  if (!commitMeta) {
-    SPDLOG_ERROR("transferMoney: Meta commit failed. Rolling back.");
-    shardA->rollbackTransfer(fromUser->id, amount, true, tx_id);
-    shardB->rollbackTransfer(toUser->id, amount, false, tx_id);
-    return false;
-  }
-
-  // 3-2. Commit Shards
-  shardA->commitTransfer(fromUser->id, amount, true, tx_id);
-  shardB->commitTransfer(toUser->id, amount, false, tx_id);
-
-  SPDLOG_INFO("transferMoney: Success. tx_id={}", tx_id);
-  return true;
-}
\ No newline at end of file
+  // 샤드 간: Try + 결정까지 기다리고 Confirm 은 코디네이터가 백그라운드로
+  db::TransactionPart debit;
+  debit.shard_id = fromUser->shard_id;
+  debit.user_id = fromUser->id;
+  debit.amount = amount;
+  debit.is_deduct = true;
+  db::TransactionPart credit;
+  credit.shard_id = toUser->shard_id;
+  credit.user_id = toUser->id;
+  credit.amount = amount;
+  credit.is_deduct = false;
+  return tcc_.execute({debit, credit});
+}
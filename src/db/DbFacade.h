@@ -1,28 +1,117 @@
 // src/db/DbFacade.h
 #pragma once
+#include "DbExecutor.h"
 #include "DbRouter.h"
+#include "TccCoordinator.h"
+#include "TransferBatcher.h"
 #include "models.h"
+#include <functional>
 #include <optional>
 #include <vector>
 
+// 로그인 시 한 번 해석해서 세션에 보관하는 정보.
+// 이후 메시지 저장은 writer 로 바로 넘어가므로 account DB 조회가 없다.
+struct UserLogin {
+  db::User user;
+  db::ShardId shard_id{};
+  std::shared_ptr<MessageBatchWriter> writer; // 유저 샤드의 group-commit writer
+};
+
 class DbFacade {
 public:
-  explicit DbFacade(const std::string &account_conninfo);
+  explicit DbFacade(const std::string &account_conninfo,
+                    const DbOptions &opts = {});
+
+  // ---- 비동기 API ----
+  // 호출 즉시 반환하고 작업은 DB 워커에서 실행된다.
+  // 콜백도 DB 워커 스레드에서 호출되므로, 세션 상태를 건드리려면 호출자가
+  // 자기 executor 로 다시 post 해야 한다.
+  using UserCallback = std::function<void(std::optional<db::User>)>;
+  using SaveCallback = MessageBatchWriter::Callback; // (ok, saved message)
+  using MessagesCallback = std::function<void(std::vector<db::Message>)>;
+  using LoginCallback = std::function<void(std::optional<UserLogin>)>;
+  using TransferCallback = TransferBatcher::Callback; // (outcome)
+
+  // 비밀번호 확인 후 username → User + 샤드 정보(라우팅 캐시) + 샤드 writer 를
+  // 한 번에 해석. 유저가 없거나 비밀번호가 틀리면 nullopt
+  void loginAsync(std::string username, std::string password,
+                  LoginCallback done);
+
+  void findUserAsync(std::string username, UserCallback done);
+  // 같은 room_id 의 저장은 순서대로 실행되고, 샤드별 group-commit writer 로
+  // 묶여 저장된다
+  void saveMessageAsync(int user_id, long long room_id, std::string content,
+                        SaveCallback done = nullptr);
+  // 로그인 정보가 있으면 라우팅 없이 샤드 writer 에 바로 넣는다 (블록하지 않음)
+  void saveMessageAsync(const UserLogin &login, long long room_id,
+                        std::string content, SaveCallback done = nullptr);
+  void loadMessagesAsync(int user_id, long long room_id, MessagesCallback done);
+  // 대량 송금용. 짧은 시간 동안 모아 배치 하나(글로벌 트랜잭션 1개)로 처리한다
+  // (TransferBatcher). 콜백은 배치 스레드에서 호출된다
+  void transferMoneyAsync(std::string from_username, std::string to_username,
+                          int amount, TransferCallback done = nullptr);
+  // 최신 → 과거 순 한 페이지 (ShardDb::getMessagesPage)
+  void loadMessagesAsync(int user_id, long long room_id,
+                         db::MessageId before_id, std::size_t limit,
+                         MessagesCallback done);
+
+  // ---- 동기 API (DB 워커 또는 io 스레드가 아닌 곳에서만 사용) ----
 
   std::optional<db::User> findUser(const std::string &username);
-  // 신규 유저 생성 (AccountDb::createUser 위임)
+  // 신규 유저 생성 (AccountDb::createUser 위임). 성공하면 유저 캐시에서 제거
   std::optional<db::User> createUser(const std::string &username,
                                      const std::string &password_hash,
                                      std::optional<std::string> email,
                                      int shard_id);
   bool saveMessage(int user_id, long long room_id, const std::string &content);
-  bool saveMessage(int user_id, long long room_id, const std::string &content);
   std::vector<db::Message> loadMessages(int user_id, long long room_id);
+  // before_id 미만 최신 limit 개 (0 이하면 최신부터), id 내림차순
+  std::vector<db::Message> loadMessages(int user_id, long long room_id,
+                                        db::MessageId before_id,
+                                        std::size_t limit);
+  // 방 히스토리: 모든 샤드에서 before 이전 최신 limit 개를 모아 커서
+  // (created_us, shard_id, id) 내림차순으로 합친다. 방 메시지는 보낸 유저의
+  // 샤드에 나뉘어 저장되므로 한 샤드만 보면 빠진다. 샤드 조회는
+  // 고정 크기 fanout_ 워커(DbOptions::fanout_threads)에서 동시에
+  std::vector<db::Message> loadRoomMessages(long long room_id,
+                                            const db::MessageCursor &before,
+                                            std::size_t limit);
+  // after_id 이후를 batch_size 개씩 오래된 순으로 on_batch 에 넘긴다
+  bool streamMessages(int user_id, long long room_id, db::MessageId after_id,
+                      std::size_t batch_size,
+                      const ShardDb::BatchCallback &on_batch);
+
+  // 샤드 이전 후 호출: 라우팅 캐시의 매핑과 유저 캐시(User.shard_id 포함,
+  // 다른 노드 포함)를 함께 제거
+  void invalidateUserRouting(int user_id, const std::string &username);
+
+  // findUser 앞단 캐시 (예: 프로세스 L1 → Redis → account DB).
+  // lookup 은 캐시 miss 일 때 load() 로 DB 를 조회한다. load 는 복사해 나중에
+  // 다시 호출해도 된다 (미리 갱신). load 는 없는 유저면 nullopt 를 반환하고,
+  // lookup 은 nullopt 를 캐시하지 않아야 한다. 서비스 시작 전에 한 번만 설정한다.
+  // load 가 돌려주는 User 는 password_hash 가 비어 있다 (캐시에 자격 증명 없음).
+  using UserLoad = std::function<std::optional<db::User>()>;
+  using UserLookup = std::function<std::optional<db::User>(
+      const std::string &username, UserLoad load)>;
+  using UserInvalidate = std::function<void(const std::string &username)>;
+  void setUserCache(UserLookup lookup, UserInvalidate invalidate);
+  // 유저 정보가 바뀌었을 때 호출: 캐시(다른 노드 포함)에서 제거
+  void invalidateUser(const std::string &username);
 
-  // TCC Orchestration
+  // 같은 샤드면 로컬 트랜잭션, 아니면 TCC (TccCoordinator).
+  // true 는 송금이 확정되었다는 뜻이고 수신 측 반영은 백그라운드에서 끝난다
   bool transferMoney(const std::string &from_username,
                      const std::string &to_username, int amount);
 
 private:
   DbRouter router_;
+  TccCoordinator tcc_;
+  TransferBatcher transfers_; // tcc_ 보다 먼저 파괴 (남은 배치 처리 후 종료)
+  UserLookup user_lookup_;
+  UserInvalidate user_invalidate_;
+  // router_ 보다 먼저 파괴되어야 하므로 뒤에 선언 (남은 작업 처리 후 종료)
+  DbExecutor executor_;
+  // loadRoomMessages 의 샤드별 조회 전용. 요청마다 스레드를 만들지 않고,
+  // executor_ 작업 뒤에 줄 서지도 않는다
+  DbExecutor fanout_;
 };
\ No newline at end of file
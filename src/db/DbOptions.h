@@ -0,0 +1,33 @@
+// src/db/DbOptions.h
+#pragma once
+#include "RoutingCache.h"
+#include <chrono>
+#include <cstddef>
+
+// 분산 송금(TCC) 백그라운드 confirm/cancel 및 복구
+struct TccOptions {
+  std::size_t threads = 2;                    // confirm/cancel 워커 수
+  std::chrono::milliseconds retry_min{200};   // 실패 시 재시도 간격 (지수 증가)
+  std::chrono::milliseconds retry_max{30000};
+  std::chrono::seconds recover_after{30};     // 이보다 오래된 미완료 건만 복구
+  std::chrono::seconds scan_interval{60};     // 복구 스캔 주기 (0 이면 시작 시 한 번)
+  std::size_t scan_limit = 500;               // 스캔 한 번에 가져올 건수
+};
+
+// transferMoneyAsync 배치 (TransferBatcher)
+struct TransferBatchOptions {
+  std::size_t max_batch = 1024;            // 배치 하나의 최대 송금 수
+  std::chrono::milliseconds max_delay{20}; // 첫 송금 기준으로 모으는 시간
+};
+
+// DB 계층 튜닝 옵션
+struct DbOptions {
+  std::size_t executor_threads = 4;   // DbFacade 비동기 워커 수
+  std::size_t fanout_threads = 4;     // 방 히스토리 샤드 동시 조회 워커 수 (샤드 수 정도)
+  std::size_t account_pool_size = 8;  // account_db 커넥션 풀 크기
+  std::size_t shard_pool_size = 4;    // 샤드별 커넥션 풀 크기
+  std::chrono::seconds shard_health_interval{30}; // 샤드 풀 점검 주기 (0 이면 끔)
+  RoutingCache::Options routing;      // user→shard 라우팅 캐시
+  TccOptions tcc;
+  TransferBatchOptions transfer_batch;
+};
@@ -3,26 +3,63 @@
 #include <iostream>
 #include <spdlog/spdlog.h>
 
-DbRouter::DbRouter(const std::string& account_conninfo)
-    : account_(account_conninfo) {}
+DbRouter::DbRouter(const std::string& account_conninfo, const DbOptions& opts)
+    : account_(account_conninfo, opts) {}
 
 std::optional<db::User> DbRouter::getUser(const std::string& username) {
     return account_.getUser(username);
 }
 
 std::shared_ptr<ShardDb> DbRouter::getShardForUser(int user_id) {
+    auto info = getShardInfoForUser(user_id);
+    if (!info) return nullptr;
+    //SPDLOG_INFO("Shard Info: {}", info->conninfo);
+    return account_.shardPools().acquire(*info);
+}
+
+std::shared_ptr<ShardDb> DbRouter::getShard(db::ShardId shard_id) {
+    auto info = account_.getShardInfo(shard_id);
+    if (!info) return nullptr;
+    return account_.shardPools().acquire(*info);
+}
+
+std::vector<db::ShardInfo> DbRouter::getShards() {
+    return account_.getShards();
+}
+
+std::optional<db::ShardInfo> DbRouter::getShardInfoForUser(int user_id) {
     int shard_id = account_.getShardId(user_id);
     if (shard_id < 0) {
         SPDLOG_WARN("Invalid shard_id for user {}", user_id);
-        return nullptr;
+        return std::nullopt;
     }
     auto info = account_.getShardInfo(shard_id);
     if (!info) {
         SPDLOG_ERROR("Shard not found for user {}", user_id);
-        return nullptr;
+        return std::nullopt;
     }
-    //SPDLOG_INFO("Shard Info: {}", info->conninfo);
-    return std::make_shared<ShardDb>(info->conninfo);
+    return info;
+}
+
+std::shared_ptr<MessageBatchWriter> DbRouter::getMessageWriter(int user_id) {
+    auto info = getShardInfoForUser(user_id);
+    if (!info) return nullptr;
+    return getMessageWriterForShard(*info);
+}
+
+std::shared_ptr<MessageBatchWriter> DbRouter::getMessageWriterForShard(const db::ShardInfo& info) {
+    std::lock_guard<std::mutex> lock(writers_mutex_);
+    auto& writer = writers_[info.id];
+    if (!writer) {
+        try {
+            writer = std::make_shared<MessageBatchWriter>(account_.shardPools(), info);
+        } catch (const std::exception& e) {
+            SPDLOG_ERROR("MessageBatchWriter for shard {} failed: {}", info.id, e.what());
+            writers_.erase(info.id);
+            return nullptr;
+        }
+    }
+    return writer;
 }
 
 std::shared_ptr<AccountDb> DbRouter::getAccountDb() {
@@ -1,18 +1,34 @@
 // src/db/DbRouter.h
 #pragma once
 #include "AccountDb.h"
+#include "DbOptions.h"
+#include "MessageBatchWriter.h"
 #include "ShardDb.h"
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 class DbRouter {
 public:
-    explicit DbRouter(const std::string& account_conninfo);
+    explicit DbRouter(const std::string& account_conninfo, const DbOptions& opts = {});
 
     std::optional<db::User> getUser(const std::string& username);
+    // 샤드 풀에서 커넥션을 빌린 ShardDb (반환값 파괴 시 반납)
     std::shared_ptr<ShardDb> getShardForUser(int user_id);
+    // shard id 를 이미 알 때 (User.shard_id 등). users 조회 없이 라우팅 캐시 + 풀
+    std::shared_ptr<ShardDb> getShard(db::ShardId shard_id);
+    std::optional<db::ShardInfo> getShardInfoForUser(int user_id);
+    // 모든 샤드 (방 히스토리처럼 샤드를 가로지르는 조회용)
+    std::vector<db::ShardInfo> getShards();
+    // 유저 샤드의 group-commit writer (샤드당 1개, 처음 요청 시 생성)
+    std::shared_ptr<MessageBatchWriter> getMessageWriter(int user_id);
+    std::shared_ptr<MessageBatchWriter> getMessageWriterForShard(const db::ShardInfo& info);
     std::shared_ptr<AccountDb> getAccountDb();
     
 private:
     AccountDb account_;
+    std::mutex writers_mutex_;
+    std::unordered_map<db::ShardId, std::shared_ptr<MessageBatchWriter>> writers_;
 };
\ No newline at end of file
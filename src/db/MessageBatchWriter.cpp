@@ -0,0 +1,104 @@
+// src/db/MessageBatchWriter.cpp
+#include "MessageBatchWriter.h"
+#include <spdlog/spdlog.h>
+
+MessageBatchWriter::MessageBatchWriter(ShardPools &pools, db::ShardInfo shard)
+    : MessageBatchWriter(pools, std::move(shard), Options{}) {}
+
+MessageBatchWriter::MessageBatchWriter(ShardPools &pools, db::ShardInfo shard,
+                                       Options opts)
+    : pools_(pools), shard_(std::move(shard)), opts_(opts),
+      thread_([this] { run(); }) {}
+
+MessageBatchWriter::~MessageBatchWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void MessageBatchWriter::enqueue(long long room_id, int user_id,
+                                 std::string content, Callback done) {
+  Pending p;
+  p.msg.room_id = room_id;
+  p.msg.user_id = user_id;
+  p.msg.content = std::move(content);
+  p.msg.shard_id = shard_.id;
+  p.done = std::move(done);
+
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(p));
+    // 첫 메시지(타이머 시작) 또는 배치가 찼을 때만 깨운다
+    notify = queue_.size() == 1 || queue_.size() >= opts_.max_batch;
+  }
+  if (notify)
+    cv_.notify_one();
+}
+
+void MessageBatchWriter::run() {
+  std::vector<Pending> batch;
+  batch.reserve(opts_.max_batch);
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty())
+        return; // stopping
+
+      // 첫 메시지 기준 max_delay 까지 더 모은다
+      auto deadline = std::chrono::steady_clock::now() + opts_.max_delay;
+      cv_.wait_until(lock, deadline, [&] {
+        return stopping_ || queue_.size() >= opts_.max_batch;
+      });
+
+      while (!queue_.empty() && batch.size() < opts_.max_batch) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+    }
+    flush(batch);
+    batch.clear();
+  }
+}
+
+void MessageBatchWriter::flush(std::vector<Pending> &batch) {
+  std::vector<db::Message> msgs;
+  msgs.reserve(batch.size());
+  for (auto &p : batch)
+    msgs.push_back(p.msg);
+
+  auto shard = pools_.acquire(shard_);
+  if (!shard) {
+    SPDLOG_ERROR("shard {} unavailable, {} messages failed", shard_.id,
+                 batch.size());
+    for (auto &p : batch) {
+      if (p.done)
+        p.done(false, p.msg);
+    }
+    return;
+  }
+
+  if (shard->insertMessages(msgs)) {
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      if (batch[i].done)
+        batch[i].done(true, msgs[i]);
+    }
+    return;
+  }
+
+  // 배치 실패: 문제 메시지만 실패 처리되도록 한 건씩 재시도
+  SPDLOG_WARN("shard {} batch insert failed ({} rows), retry one by one",
+              shard_.id, batch.size());
+  for (auto &p : batch) {
+    std::vector<db::Message> one{p.msg};
+    bool ok = shard->insertMessages(one);
+    if (p.done)
+      p.done(ok, ok ? one[0] : p.msg);
+  }
+}
@@ -0,0 +1,58 @@
+// src/db/MessageBatchWriter.h
+#pragma once
+#include "ShardPools.h"
+#include "models.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 샤드별 group-commit 메시지 writer.
+// enqueue 된 메시지를 max_delay 동안 또는 max_batch 개까지 모아
+// ShardDb::insertMessages 한 번(트랜잭션 1회)으로 저장하고, 메시지별로 완료를 알린다.
+class MessageBatchWriter {
+public:
+  // 저장된 메시지 (id, shard_id, created_us 가 채워짐). ok=false 면 id 는 0
+  using Callback = std::function<void(bool ok, const db::Message &saved)>;
+
+  struct Options {
+    std::size_t max_batch = 256;
+    std::chrono::milliseconds max_delay{5};
+  };
+
+  // flush 마다 샤드 풀에서 커넥션을 빌려 쓴다
+  MessageBatchWriter(ShardPools &pools, db::ShardInfo shard);
+  MessageBatchWriter(ShardPools &pools, db::ShardInfo shard, Options opts);
+  ~MessageBatchWriter();
+
+  MessageBatchWriter(const MessageBatchWriter &) = delete;
+  MessageBatchWriter &operator=(const MessageBatchWriter &) = delete;
+
+  db::ShardId shardId() const { return shard_.id; }
+
+  void enqueue(long long room_id, int user_id, std::string content,
+               Callback done = nullptr);
+
+private:
+  struct Pending {
+    db::Message msg;
+    Callback done;
+  };
+
+  void run();
+  void flush(std::vector<Pending> &batch);
+
+  ShardPools &pools_;
+  db::ShardInfo shard_;
+  Options opts_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Pending> queue_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
@@ -0,0 +1,76 @@
+// src/db/ModelCodec.h
+#pragma once
+#include "BinaryCodec.h"
+#include "models.h"
+
+// db:: 모델의 캐시용 바이너리 스키마 (cache::codec).
+// 필드는 끝에만 추가하고, 순서/타입을 바꾸면 version 을 올린다.
+namespace cache {
+namespace codec {
+
+// password_hash 는 캐시에 싣지 않는다 (디코딩된 User 는 빈 문자열)
+template <> struct Schema<db::User> {
+  static constexpr std::uint8_t version = 2;
+  static constexpr auto fields() {
+    return std::make_tuple(Field("id", &db::User::id),
+                           Field("username", &db::User::username),
+                           Field("shard_id", &db::User::shard_id),
+                           Field("email", &db::User::email),
+                           Field("money", &db::User::money),
+                           Field("held_money", &db::User::held_money),
+                           Field("created_at", &db::User::created_at));
+  }
+};
+
+template <> struct Schema<db::ShardInfo> {
+  static constexpr std::uint8_t version = 1;
+  static constexpr auto fields() {
+    return std::make_tuple(Field("id", &db::ShardInfo::id),
+                           Field("name", &db::ShardInfo::name),
+                           Field("conninfo", &db::ShardInfo::conninfo),
+                           Field("created_at", &db::ShardInfo::created_at));
+  }
+};
+
+template <> struct Schema<db::Message> {
+  static constexpr std::uint8_t version = 1;
+  static constexpr auto fields() {
+    return std::make_tuple(Field("id", &db::Message::id),
+                           Field("room_id", &db::Message::room_id),
+                           Field("user_id", &db::Message::user_id),
+                           Field("content", &db::Message::content),
+                           Field("created_at", &db::Message::created_at),
+                           Field("shard_id", &db::Message::shard_id),
+                           Field("created_us", &db::Message::created_us));
+  }
+};
+
+template <> struct Schema<db::ChatRoom> {
+  static constexpr std::uint8_t version = 1;
+  static constexpr auto fields() {
+    return std::make_tuple(Field("id", &db::ChatRoom::id),
+                           Field("name", &db::ChatRoom::name),
+                           Field("created_at", &db::ChatRoom::created_at));
+  }
+};
+
+template <> struct Schema<db::Transaction> {
+  static constexpr std::uint8_t version = 1;
+  static constexpr auto fields() {
+    return std::make_tuple(Field("id", &db::Transaction::id),
+                           Field("status", &db::Transaction::status),
+                           Field("created_at", &db::Transaction::created_at));
+  }
+};
+
+template <> struct Schema<db::Wallet> {
+  static constexpr std::uint8_t version = 1;
+  static constexpr auto fields() {
+    return std::make_tuple(Field("user_id", &db::Wallet::user_id),
+                           Field("money", &db::Wallet::money),
+                           Field("held_money", &db::Wallet::held_money));
+  }
+};
+
+} // namespace codec
+} // namespace cache
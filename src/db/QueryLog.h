@@ -0,0 +1,84 @@
+// src/db/QueryLog.h
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <spdlog/spdlog.h>
+#include <string>
+
+// 카테고리별 1/N 로그 샘플링. every_n == 0 이면 끔, 1 이면 전부 기록.
+class LogSampler {
+public:
+  explicit LogSampler(std::uint32_t every_n = 0) : every_n_(every_n) {}
+
+  void setEveryN(std::uint32_t every_n) {
+    every_n_.store(every_n, std::memory_order_relaxed);
+  }
+  std::uint32_t everyN() const {
+    return every_n_.load(std::memory_order_relaxed);
+  }
+
+  bool sample() {
+    auto n = everyN();
+    if (n <= 1)
+      return n == 1;
+    return counter_.fetch_add(1, std::memory_order_relaxed) % n == 0;
+  }
+
+private:
+  std::atomic<std::uint32_t> every_n_;
+  std::atomic<std::uint64_t> counter_{0};
+};
+
+namespace querylog {
+
+// 쿼리 시간 샘플링 (기본 1/1000)
+inline LogSampler &sampler() {
+  static LogSampler s(1000);
+  return s;
+}
+
+// 이 시간 이상 걸린 쿼리는 샘플링과 무관하게 WARN 으로 남긴다
+inline std::atomic<std::int64_t> &slowThresholdUs() {
+  static std::atomic<std::int64_t> us{100 * 1000};
+  return us;
+}
+
+inline void configure(std::uint32_t sample_every_n, std::int64_t slow_ms) {
+  sampler().setEveryN(sample_every_n);
+  slowThresholdUs().store(slow_ms * 1000, std::memory_order_relaxed);
+}
+
+// SpdlogLoggerImpl 이 기록하는 현재 스레드의 마지막 SQL (slow query 로그용)
+inline std::string &lastQuery() {
+  thread_local std::string query;
+  return query;
+}
+
+} // namespace querylog
+
+// 스코프 동안의 DB 호출 시간을 잰다.
+// 임계값 이상이면 WARN + SQL, 아니면 샘플링된 경우에만 INFO.
+class QueryTimer {
+public:
+  explicit QueryTimer(const char *name)
+      : name_(name), start_(std::chrono::steady_clock::now()) {}
+  QueryTimer(const QueryTimer &) = delete;
+  QueryTimer &operator=(const QueryTimer &) = delete;
+
+  ~QueryTimer() {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start_)
+                  .count();
+    if (us >= querylog::slowThresholdUs().load(std::memory_order_relaxed)) {
+      SPDLOG_WARN("slow query {} {} us: {}", name_, us, querylog::lastQuery());
+    } else if (querylog::sampler().sample()) {
+      SPDLOG_INFO("query {} {} us (1/{} sampled)", name_, us,
+                  querylog::sampler().everyN());
+    }
+  }
+
+private:
+  const char *name_;
+  std::chrono::steady_clock::time_point start_;
+};
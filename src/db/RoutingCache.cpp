@@ -0,0 +1,79 @@
+// src/db/RoutingCache.cpp
+#include "RoutingCache.h"
+
+RoutingCache::RoutingCache() : RoutingCache(Options{}) {}
+
+RoutingCache::RoutingCache(Options opts) : opts_(opts) {}
+
+std::optional<db::ShardId> RoutingCache::getUserShard(db::UserId user_id) {
+  auto &b = bucketFor(user_id);
+  std::lock_guard<std::mutex> lock(b.mutex);
+  auto it = b.users.find(user_id);
+  if (it == b.users.end())
+    return std::nullopt;
+  if (it->second.version != version_.load(std::memory_order_acquire) ||
+      it->second.expires <= Clock::now()) {
+    b.users.erase(it);
+    return std::nullopt;
+  }
+  return it->second.shard_id;
+}
+
+void RoutingCache::putUserShard(db::UserId user_id, db::ShardId shard_id) {
+  auto &b = bucketFor(user_id);
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(b.mutex);
+  if (b.users.size() >= opts_.max_users / kBucketCount + 1 &&
+      b.users.find(user_id) == b.users.end()) {
+    evictOne(b, now);
+  }
+  b.users[user_id] = UserEntry{shard_id, now + opts_.user_ttl,
+                               version_.load(std::memory_order_acquire)};
+}
+
+void RoutingCache::evictOne(Bucket &b, Clock::time_point now) {
+  // 만료/구버전 항목을 우선 제거하고, 없으면 임의의 항목 하나를 버린다
+  auto version = version_.load(std::memory_order_acquire);
+  for (auto it = b.users.begin(); it != b.users.end(); ++it) {
+    if (it->second.expires <= now || it->second.version != version) {
+      b.users.erase(it);
+      return;
+    }
+  }
+  if (!b.users.empty())
+    b.users.erase(b.users.begin());
+}
+
+std::optional<db::ShardInfo> RoutingCache::getShardInfo(db::ShardId shard_id) {
+  std::lock_guard<std::mutex> lock(shards_mutex_);
+  auto it = shards_.find(shard_id);
+  if (it == shards_.end())
+    return std::nullopt;
+  if (it->second.version != version_.load(std::memory_order_acquire) ||
+      it->second.expires <= Clock::now()) {
+    shards_.erase(it);
+    return std::nullopt;
+  }
+  return it->second.info;
+}
+
+void RoutingCache::putShardInfo(const db::ShardInfo &info) {
+  std::lock_guard<std::mutex> lock(shards_mutex_);
+  shards_[info.id] = ShardEntry{info, Clock::now() + opts_.shard_ttl,
+                                version_.load(std::memory_order_acquire)};
+}
+
+void RoutingCache::invalidateUser(db::UserId user_id) {
+  auto &b = bucketFor(user_id);
+  std::lock_guard<std::mutex> lock(b.mutex);
+  b.users.erase(user_id);
+}
+
+void RoutingCache::invalidateShard(db::ShardId shard_id) {
+  std::lock_guard<std::mutex> lock(shards_mutex_);
+  shards_.erase(shard_id);
+}
+
+void RoutingCache::invalidateAll() {
+  version_.fetch_add(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,69 @@
+// src/db/RoutingCache.h
+#pragma once
+#include "models.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// user_id → shard_id, shard_id → ShardInfo 인메모리 라우팅 테이블.
+// 매핑은 거의 바뀌지 않으므로 라우팅을 SQL 2회 대신 메모리 조회로 끝낸다.
+//  - user 매핑은 해시 버킷으로 나눠 버킷별 mutex, 버킷당 최대 개수로 메모리 제한
+//  - TTL 만료 + 전역 version (invalidateAll) 로 무효화
+//  - createUser / 샤드 이전 시 invalidateUser 를 명시적으로 호출
+class RoutingCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    std::size_t max_users = 1000000;
+    std::chrono::seconds user_ttl{600};
+    std::chrono::seconds shard_ttl{60};
+  };
+
+  RoutingCache();
+  explicit RoutingCache(Options opts);
+
+  std::optional<db::ShardId> getUserShard(db::UserId user_id);
+  void putUserShard(db::UserId user_id, db::ShardId shard_id);
+
+  std::optional<db::ShardInfo> getShardInfo(db::ShardId shard_id);
+  void putShardInfo(const db::ShardInfo &info);
+
+  void invalidateUser(db::UserId user_id);
+  void invalidateShard(db::ShardId shard_id);
+  // 모든 항목을 한 번에 무효화 (version 증가, 실제 제거는 조회 시점에)
+  void invalidateAll();
+
+private:
+  static constexpr std::size_t kBucketCount = 64;
+
+  struct UserEntry {
+    db::ShardId shard_id;
+    Clock::time_point expires;
+    std::uint64_t version;
+  };
+  struct Bucket {
+    std::mutex mutex;
+    std::unordered_map<db::UserId, UserEntry> users;
+  };
+  struct ShardEntry {
+    db::ShardInfo info;
+    Clock::time_point expires;
+    std::uint64_t version;
+  };
+
+  Bucket &bucketFor(db::UserId user_id) {
+    return buckets_[static_cast<std::size_t>(user_id) % kBucketCount];
+  }
+  void evictOne(Bucket &b, Clock::time_point now);
+
+  Options opts_;
+  std::atomic<std::uint64_t> version_{0};
+  std::array<Bucket, kBucketCount> buckets_;
+  std::mutex shards_mutex_;
+  std::unordered_map<db::ShardId, ShardEntry> shards_;
+};
@@ -1,7 +1,11 @@
 // src/db/ShardDb.cpp
 #include "ShardDb.h"
+#include "QueryLog.h"
 #include "SpdlogLoggerImpl.h"
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <soci/postgresql/soci-postgresql.h>
 #include <spdlog/spdlog.h>
 
@@ -11,8 +15,16 @@ ShardDb::ShardDb(const std::string &conninfo)
   sql_.set_logger(slog);
 }
 
+ShardDb::ShardDb(soci::connection_pool &pool) : sql_(pool) {
+  if (!sql_.is_connected()) {
+    SPDLOG_WARN("ShardDb: pooled connection lost, reconnecting");
+    sql_.reconnect();
+  }
+}
+
 bool ShardDb::insertMessage(long long room_id, int user_id,
                             const std::string &content) {
+  QueryTimer timer("insertMessage");
   try {
     sql_
         << "INSERT INTO messages(room_id, user_id, content) VALUES(:r, :u, :c)",
@@ -25,23 +37,217 @@ bool ShardDb::insertMessage(long long room_id, int user_id,
   }
 }
 
-std::vector<db::Message> ShardDb::getMessages(long long room_id) {
-  std::vector<db::Message> msgs;
+// PostgreSQL 배열 리터럴. 값은 바인딩 파라미터로 넘기므로 SQL 인젝션과 무관하다.
+template <typename T>
+static std::string toArrayLiteral(const std::vector<db::Message> &msgs,
+                                  T db::Message::*field) {
+  std::string out = "{";
+  for (std::size_t i = 0; i < msgs.size(); ++i) {
+    if (i)
+      out += ',';
+    out += std::to_string(msgs[i].*field);
+  }
+  out += '}';
+  return out;
+}
+
+static std::string toTextArrayLiteral(const std::vector<db::Message> &msgs) {
+  std::string out = "{";
+  for (std::size_t i = 0; i < msgs.size(); ++i) {
+    if (i)
+      out += ',';
+    out += '"';
+    for (char ch : msgs[i].content) {
+      if (ch == '"' || ch == '\\')
+        out += '\\';
+      out += ch;
+    }
+    out += '"';
+  }
+  out += '}';
+  return out;
+}
+
+// created_at(TIMESTAMP) 의 epoch 마이크로초. double 을 거치지 않도록 초와
+// 마이크로초를 정수로 따로 꺼낸다
+static std::string createdUs(const std::string &col) {
+  return "(CAST(extract(epoch FROM date_trunc('second', " + col +
+         ")) AS bigint) * 1000000 + CAST(extract(microseconds FROM " + col +
+         ") AS bigint) % 1000000)";
+}
+
+bool ShardDb::insertMessages(std::vector<db::Message> &msgs) {
+  QueryTimer timer("insertMessages");
+  if (msgs.empty())
+    return true;
   try {
-    soci::rowset<db::Message> rs =
-        (sql_.prepare
-             << "SELECT * FROM messages WHERE room_id = :r ORDER BY id",
-         soci::use(room_id));
-    for (auto &m : rs)
-      msgs.push_back(m);
+    std::string rooms = toArrayLiteral(msgs, &db::Message::room_id);
+    std::string users = toArrayLiteral(msgs, &db::Message::user_id);
+    std::string contents = toTextArrayLiteral(msgs);
+
+    // RETURNING 순서는 입력 순서가 보장되지 않으므로 id 를 먼저 행마다 뽑고
+    // ordinality(1 부터 입력 순서)와 함께 돌려받아 제자리에 놓는다
+    std::vector<long long> ords(msgs.size());
+    std::vector<db::MessageId> got(msgs.size());
+    std::vector<long long> created(msgs.size());
+    std::string query =
+        "WITH input AS ("
+        "  SELECT t.room_id, t.user_id, t.content, t.ord,"
+        "  nextval(pg_get_serial_sequence('messages', 'id')) AS id"
+        "  FROM unnest(CAST(:r AS bigint[]), CAST(:u AS int[]),"
+        "  CAST(:c AS text[])) WITH ORDINALITY"
+        "  AS t(room_id, user_id, content, ord)), "
+        "ins AS ("
+        "  INSERT INTO messages(id, room_id, user_id, content)"
+        "  SELECT id, room_id, user_id, content FROM input"
+        "  RETURNING id, created_at) "
+        "SELECT i.ord, i.id, " +
+        createdUs("ins.created_at") + " FROM input i JOIN ins ON ins.id = i.id";
+    sql_ << query, soci::use(rooms, "r"), soci::use(users, "u"),
+        soci::use(contents, "c"), soci::into(ords), soci::into(got),
+        soci::into(created);
+    if (got.size() != msgs.size()) {
+      SPDLOG_ERROR("insertMessages: {} ids for {} rows", got.size(),
+                   msgs.size());
+      return false;
+    }
+    for (std::size_t i = 0; i < got.size(); ++i) {
+      if (ords[i] < 1 || ords[i] > static_cast<long long>(msgs.size()))
+        return false;
+      auto &m = msgs[ords[i] - 1];
+      m.id = got[i];
+      m.created_us = created[i];
+    }
+    return true;
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("insertMessages error: {}", e.what());
+    return false;
+  }
+}
+
+// fetchMessages 가 받는 컬럼 (순서 고정)
+static const std::string messageColumns =
+    "SELECT id, room_id, user_id, content, created_at, " +
+    createdUs("created_at") + " ";
+
+bool ShardDb::fetchMessages(const std::string &query, long long room_id,
+                            db::MessageId key, std::size_t limit,
+                            std::vector<db::Message> &out,
+                            const long long *created_us) {
+  out.clear();
+  if (limit == 0)
+    return true;
+
+  // SOCI bulk into: 벡터 크기만큼 받아오고 실제 행 수로 줄여준다
+  std::vector<db::MessageId> ids(limit);
+  std::vector<long long> rooms(limit);
+  std::vector<int> users(limit);
+  std::vector<std::string> contents(limit);
+  std::vector<std::tm> created(limit);
+  std::vector<long long> created_at_us(limit);
+  int lim = static_cast<int>(limit);
+  std::string sql = messageColumns + query;
+  try {
+    // 쿼리에 없는 이름으로 바인딩하면 오류이므로 :t 는 있을 때만
+    if (created_us)
+      sql_ << sql, soci::use(room_id, "r"), soci::use(*created_us, "t"),
+          soci::use(key, "k"), soci::use(lim, "l"), soci::into(ids),
+          soci::into(rooms), soci::into(users), soci::into(contents),
+          soci::into(created), soci::into(created_at_us);
+    else
+      sql_ << sql, soci::use(room_id, "r"), soci::use(key, "k"),
+          soci::use(lim, "l"), soci::into(ids), soci::into(rooms),
+          soci::into(users), soci::into(contents), soci::into(created),
+          soci::into(created_at_us);
   } catch (const std::exception &e) {
     SPDLOG_ERROR("SOCI error: {}", e.what());
+    return false;
+  }
+
+  out.resize(ids.size());
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    out[i].id = ids[i];
+    out[i].room_id = rooms[i];
+    out[i].user_id = users[i];
+    out[i].content = std::move(contents[i]);
+    out[i].created_at = created[i];
+    out[i].created_us = created_at_us[i];
+  }
+  return true;
+}
+
+std::vector<db::Message> ShardDb::getMessagesPage(long long room_id,
+                                                  db::MessageId before_id,
+                                                  std::size_t limit) {
+  QueryTimer timer("getMessagesPage");
+  if (before_id <= 0)
+    before_id = std::numeric_limits<db::MessageId>::max();
+  limit = std::min(limit, max_page_size);
+
+  std::vector<db::Message> msgs;
+  fetchMessages("FROM messages WHERE room_id = :r AND id < :k "
+                "ORDER BY id DESC LIMIT :l",
+                room_id, before_id, limit, msgs);
+  return msgs;
+}
+
+std::vector<db::Message> ShardDb::getMessagesBefore(long long room_id,
+                                                    long long before_us,
+                                                    db::MessageId before_id,
+                                                    std::size_t limit) {
+  QueryTimer timer("getMessagesBefore");
+  limit = std::min(limit, max_page_size);
+
+  std::vector<db::Message> msgs;
+  if (before_us <= 0) {
+    fetchMessages("FROM messages WHERE room_id = :r AND id > :k "
+                  "ORDER BY created_at DESC, id DESC LIMIT :l",
+                  room_id, 0, limit, msgs);
+    return msgs;
+  }
+  fetchMessages("FROM messages WHERE room_id = :r AND (created_at, id) < "
+                "(TIMESTAMP 'epoch' + :t * INTERVAL '1 microsecond', :k) "
+                "ORDER BY created_at DESC, id DESC LIMIT :l",
+                room_id, before_id, limit, msgs, &before_us);
+  return msgs;
+}
+
+bool ShardDb::streamMessages(long long room_id, db::MessageId after_id,
+                             std::size_t batch_size,
+                             const BatchCallback &on_batch) {
+  QueryTimer timer("streamMessages");
+  batch_size = std::clamp<std::size_t>(batch_size, 1, max_page_size);
+
+  // PostgreSQL 백엔드는 결과 전체를 클라이언트로 받아오므로 커서 하나로
+  // 읽지 않고 배치마다 keyset 쿼리를 새로 낸다
+  std::vector<db::Message> batch;
+  for (;;) {
+    if (!fetchMessages("FROM messages WHERE room_id = :r AND id > :k "
+                       "ORDER BY id LIMIT :l",
+                       room_id, after_id, batch_size, batch))
+      return false;
+    if (batch.empty())
+      return true;
+    after_id = batch.back().id;
+    bool last = batch.size() < batch_size;
+    if (!on_batch(batch) || last)
+      return true;
   }
+}
+
+std::vector<db::Message> ShardDb::getMessages(long long room_id) {
+  std::vector<db::Message> msgs;
+  streamMessages(room_id, 0, max_page_size,
+                 [&msgs](const std::vector<db::Message> &batch) {
+                   msgs.insert(msgs.end(), batch.begin(), batch.end());
+                   return true;
+                 });
   return msgs;
 }
 
 // TCC Implementation
 std::optional<db::Wallet> ShardDb::getWallet(int user_id) {
+  QueryTimer timer("getWallet");
   try {
     db::Wallet w;
     soci::indicator ind;
@@ -57,82 +263,265 @@ std::optional<db::Wallet> ShardDb::getWallet(int user_id) {
   }
 }
 
-bool ShardDb::prepareTransfer(int user_id, int amount, bool is_deduct,
-                              const std::string &tx_id) {
+// 참여자를 유저별로 상계한다 (한 유저가 보내고 받는 배치). users 는 오름차순
+namespace {
+struct UserTotals {
+  std::vector<int> users;
+  std::vector<int> holds; // 예약할 금액 max(0, 보내는 합계 - 받는 합계)
+  std::vector<int> nets;  // confirm 때 잔액 변화 (받는 합계 - 보내는 합계)
+};
+} // namespace
+
+static UserTotals netByUser(const std::vector<db::TransactionPart> &parts) {
+  std::map<int, int> totals;
+  for (auto &p : parts)
+    totals[p.user_id] += p.is_deduct ? -p.amount : p.amount;
+  UserTotals out;
+  for (auto &[user, net] : totals) {
+    out.users.push_back(user);
+    out.holds.push_back(std::max(0, -net));
+    out.nets.push_back(net);
+  }
+  return out;
+}
+
+static std::string toArrayLiteral(const std::vector<int> &values) {
+  std::string out = "{";
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    if (i)
+      out += ',';
+    out += std::to_string(values[i]);
+  }
+  out += '}';
+  return out;
+}
+
+// (tx_id, user_id) 별 트랜잭션 advisory lock. 같은 참여자의 Try/Confirm/Cancel 이
+// 동시에 도착해도 한 단계씩 실행되므로 아래 NOT EXISTS 검사가 READ COMMITTED
+// 에서도 경쟁하지 않는다. users 는 오름차순이라 여러 유저를 잡아도 데드락이 없다
+static void lockParticipants(soci::session &sql, const std::string &tx_id,
+                             const std::string &users) {
+  sql << "SELECT pg_advisory_xact_lock(hashtext(:tx), u) "
+         "FROM unnest(CAST(:u AS int[])) AS u",
+      soci::use(tx_id, "tx"), soci::use(users, "u");
+}
+
+// transfer_log(tx_id, user_id, phase, amount): (tx_id, user_id) 별로 단계마다 한 행.
+// 지갑 변경과 같은 문장에서 기록하므로 같은 tx_id 로 다시 호출돼도 한 번만 반영된다.
+// 모든 단계는 lockParticipants 를 잡은 트랜잭션 안에서 실행한다.
+//  - TRY     : amount = 실제 예약액 (잔액 부족이면 0). 어떤 기록이든 있으면 건너뜀
+//  - CONFIRM : TRY 가 있고 CANCEL 이 없을 때만. amount = 상계 금액. 예약액을 풀어
+//              잔액에 돌려놓고 상계 금액을 더한다 (예약액 + 상계 < 0 이면 거부)
+//  - CANCEL  : CONFIRM 이 없을 때만. TRY 의 예약액을 되돌린다 (없으면 empty rollback)
+bool ShardDb::prepareTransfers(const std::string &tx_id,
+                               const std::vector<db::TransactionPart> &parts,
+                               std::unordered_map<int, int> &held) {
+  QueryTimer timer("prepareTransfers");
+  held.clear();
+  if (parts.empty())
+    return true;
+  auto totals = netByUser(parts);
+  std::string users = toArrayLiteral(totals.users);
+  std::string holds = toArrayLiteral(totals.holds);
   try {
-    if (is_deduct) {
-      // Check balance and reserve
-      soci::statement st =
-          (sql_.prepare << "UPDATE wallets SET money = money - :a, held_money "
-                           "= held_money + :a "
-                           "WHERE user_id = :u AND money >= :a",
-           soci::use(amount, "a"), soci::use(amount, "a"),
-           soci::use(user_id, "u"));
-      st.execute(true);
-      if (st.get_affected_rows() == 0) {
-        SPDLOG_WARN("prepareTransfer: Insufficient funds or user not found. "
-                    "user_id={}, amount={}",
-                    user_id, amount);
-        return false;
-      }
-    } else {
-      // Ensure wallet exists for receiver
-      int count = 0;
-      sql_ << "SELECT count(*) FROM wallets WHERE user_id = :u",
-          soci::use(user_id), soci::into(count);
-      if (count == 0) {
-        sql_ << "INSERT INTO wallets(user_id, money, held_money) VALUES(:u, 0, "
-                "0)",
-            soci::use(user_id);
-      }
-    }
-    SPDLOG_INFO("prepareTransfer success: user_id={}, is_deduct={}", user_id,
-                is_deduct);
+    soci::transaction tr(sql_);
+    lockParticipants(sql_, tx_id, users);
+    // 받는 쪽 지갑이 없으면 생성
+    sql_ << "INSERT INTO wallets(user_id, money, held_money) "
+            "SELECT u, 0, 0 FROM unnest(CAST(:u AS int[])) AS u "
+            "ON CONFLICT (user_id) DO NOTHING",
+        soci::use(users, "u");
+    // 유저별 예약은 전부 아니면 0 (잔액 부족한 유저만 실패)
+    sql_ << "WITH d(user_id, amount) AS ("
+            "  SELECT * FROM unnest(CAST(:u AS int[]), CAST(:a AS int[]))), "
+            "todo AS ("
+            "  SELECT d.user_id, d.amount FROM d WHERE NOT EXISTS ("
+            "    SELECT 1 FROM transfer_log l"
+            "    WHERE l.tx_id = :tx1 AND l.user_id = d.user_id)), "
+            "hold AS ("
+            "  UPDATE wallets w SET money = w.money - t.amount,"
+            "  held_money = w.held_money + t.amount FROM todo t"
+            "  WHERE w.user_id = t.user_id AND t.amount > 0"
+            "  AND w.money >= t.amount RETURNING w.user_id, t.amount) "
+            "INSERT INTO transfer_log(tx_id, user_id, phase, amount) "
+            "SELECT :tx2, t.user_id, 1, COALESCE(h.amount, 0) "
+            "FROM todo t LEFT JOIN hold h ON h.user_id = t.user_id",
+        soci::use(users, "u"), soci::use(holds, "a"), soci::use(tx_id, "tx1"),
+        soci::use(tx_id, "tx2");
+
+    // 이번에 기록한 것 + 재시도 전에 기록된 것. 취소된 유저는 빠진다
+    std::vector<int> ids(totals.users.size());
+    std::vector<int> amounts(totals.users.size());
+    sql_ << "SELECT l.user_id, l.amount FROM transfer_log l "
+            "WHERE l.tx_id = :tx AND l.phase = 1 "
+            "AND l.user_id = ANY(CAST(:u AS int[])) "
+            "AND NOT EXISTS (SELECT 1 FROM transfer_log c WHERE c.tx_id = "
+            ":tx2 AND c.user_id = l.user_id AND c.phase = 3)",
+        soci::use(tx_id, "tx"), soci::use(users, "u"),
+        soci::use(tx_id, "tx2"), soci::into(ids), soci::into(amounts);
+    tr.commit();
+
+    for (std::size_t i = 0; i < ids.size(); ++i)
+      held[ids[i]] = amounts[i];
+    SPDLOG_DEBUG("prepareTransfers: tx {} users={} tried={}", tx_id,
+                 totals.users.size(), held.size());
     return true;
   } catch (const std::exception &e) {
-    SPDLOG_ERROR("prepareTransfer error: {}", e.what());
+    SPDLOG_ERROR("prepareTransfers error: {}", e.what());
+    held.clear();
     return false;
   }
 }
 
-bool ShardDb::commitTransfer(int user_id, int amount, bool is_deduct,
-                             const std::string &tx_id) {
+bool ShardDb::commitTransfers(const std::string &tx_id,
+                              const std::vector<db::TransactionPart> &parts) {
+  QueryTimer timer("commitTransfers");
+  if (parts.empty())
+    return true;
+  auto totals = netByUser(parts);
+  std::string users = toArrayLiteral(totals.users);
+  std::string nets = toArrayLiteral(totals.nets);
   try {
-    if (is_deduct) {
-      // Burn held money
-      sql_ << "UPDATE wallets SET held_money = held_money - :a WHERE user_id = "
-              ":u",
-          soci::use(amount), soci::use(user_id);
-    } else {
-      // Add real money
-      sql_ << "UPDATE wallets SET money = money + :a WHERE user_id = :u",
-          soci::use(amount), soci::use(user_id);
+    soci::transaction tr(sql_);
+    lockParticipants(sql_, tx_id, users);
+    sql_ << "WITH d(user_id, net) AS ("
+            "  SELECT * FROM unnest(CAST(:u AS int[]), CAST(:n AS int[]))), "
+            "logged AS ("
+            "  INSERT INTO transfer_log(tx_id, user_id, phase, amount)"
+            "  SELECT :tx1, d.user_id, 2, d.net FROM d"
+            "  JOIN transfer_log l ON l.tx_id = :tx2"
+            "  AND l.user_id = d.user_id AND l.phase = 1"
+            "  WHERE l.amount + d.net >= 0 AND NOT EXISTS ("
+            "    SELECT 1 FROM transfer_log c WHERE c.tx_id = :tx4"
+            "    AND c.user_id = d.user_id AND c.phase = 3)"
+            "  ON CONFLICT DO NOTHING RETURNING user_id, amount) "
+            "UPDATE wallets w SET held_money = w.held_money - t.amount,"
+            " money = w.money + t.amount + g.amount "
+            "FROM logged g JOIN transfer_log t ON t.user_id = g.user_id"
+            " AND t.tx_id = :tx3 AND t.phase = 1 "
+            "WHERE w.user_id = g.user_id",
+        soci::use(users, "u"), soci::use(nets, "n"),
+        soci::use(tx_id, "tx1"), soci::use(tx_id, "tx2"),
+        soci::use(tx_id, "tx3"), soci::use(tx_id, "tx4");
+
+    int confirmed = 0;
+    sql_ << "SELECT count(*) FROM transfer_log WHERE tx_id = :tx "
+            "AND phase = 2 AND user_id = ANY(CAST(:u AS int[]))",
+        soci::use(tx_id, "tx"), soci::use(users, "u"), soci::into(confirmed);
+    tr.commit();
+
+    if (confirmed != static_cast<int>(totals.users.size())) {
+      SPDLOG_ERROR("commitTransfers: tx {} confirmed {}/{} (missing try, "
+                   "canceled or short hold)",
+                   tx_id, confirmed, totals.users.size());
+      return false;
     }
-    SPDLOG_INFO("commitTransfer success: user_id={}, is_deduct={}", user_id,
-                is_deduct);
+    SPDLOG_DEBUG("commitTransfers: tx {} users={}", tx_id, confirmed);
     return true;
   } catch (const std::exception &e) {
-    SPDLOG_ERROR("commitTransfer error: {}", e.what());
+    SPDLOG_ERROR("commitTransfers error: {}", e.what());
     return false;
   }
 }
 
+bool ShardDb::rollbackTransfers(const std::string &tx_id,
+                                const std::vector<db::TransactionPart> &parts) {
+  QueryTimer timer("rollbackTransfers");
+  if (parts.empty())
+    return true;
+  std::string users = toArrayLiteral(netByUser(parts).users);
+  try {
+    soci::transaction tr(sql_);
+    lockParticipants(sql_, tx_id, users);
+    // cancel 기록을 먼저 남기므로 이후 도착한 try / confirm 은 거부된다
+    sql_ << "WITH d(user_id) AS (SELECT * FROM unnest(CAST(:u AS int[]))), "
+            "logged AS ("
+            "  INSERT INTO transfer_log(tx_id, user_id, phase, amount)"
+            "  SELECT :tx1, d.user_id, 3, 0 FROM d WHERE NOT EXISTS ("
+            "    SELECT 1 FROM transfer_log l WHERE l.tx_id = :tx2"
+            "    AND l.user_id = d.user_id AND l.phase = 2)"
+            "  ON CONFLICT DO NOTHING RETURNING user_id) "
+            "UPDATE wallets w SET money = w.money + t.amount,"
+            " held_money = w.held_money - t.amount "
+            "FROM logged g JOIN transfer_log t ON t.user_id = g.user_id"
+            " AND t.tx_id = :tx3 AND t.phase = 1 "
+            "WHERE w.user_id = g.user_id AND t.amount > 0",
+        soci::use(users, "u"), soci::use(tx_id, "tx1"),
+        soci::use(tx_id, "tx2"), soci::use(tx_id, "tx3");
+    tr.commit();
+    SPDLOG_DEBUG("rollbackTransfers: tx {} users={}", tx_id, parts.size());
+    return true;
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("rollbackTransfers error: {}", e.what());
+    return false;
+  }
+}
+
+static db::TransactionPart singlePart(int user_id, int amount, bool is_deduct) {
+  db::TransactionPart part;
+  part.user_id = user_id;
+  part.amount = amount;
+  part.is_deduct = is_deduct;
+  return part;
+}
+
+bool ShardDb::prepareTransfer(int user_id, int amount, bool is_deduct,
+                              const std::string &tx_id) {
+  std::unordered_map<int, int> held;
+  if (!prepareTransfers(tx_id, {singlePart(user_id, amount, is_deduct)}, held))
+    return false;
+  auto it = held.find(user_id);
+  if (it == held.end()) {
+    SPDLOG_WARN("prepareTransfer: tx {} already canceled", tx_id);
+    return false;
+  }
+  if (is_deduct && it->second != amount) {
+    SPDLOG_WARN("prepareTransfer: Insufficient funds or user not found. "
+                "user_id={}, amount={}",
+                user_id, amount);
+    return false;
+  }
+  return true;
+}
+
+bool ShardDb::commitTransfer(int user_id, int amount, bool is_deduct,
+                             const std::string &tx_id) {
+  return commitTransfers(tx_id, {singlePart(user_id, amount, is_deduct)});
+}
+
 bool ShardDb::rollbackTransfer(int user_id, int amount, bool is_deduct,
                                const std::string &tx_id) {
+  return rollbackTransfers(tx_id, {singlePart(user_id, amount, is_deduct)});
+}
+
+bool ShardDb::transferLocal(int from_user_id, int to_user_id, int amount) {
+  QueryTimer timer("transferLocal");
   try {
-    if (is_deduct) {
-      // Restore money
-      sql_ << "UPDATE wallets SET money = money + :a, held_money = held_money "
-              "- :a WHERE user_id = :u",
-          soci::use(amount), soci::use(amount), soci::use(user_id);
-    } else {
-      // No-op for receiver
+    // debit 이 0 행이면 credit 도 0 행 → 아무것도 바뀌지 않는다
+    int credited = 0;
+    sql_ << "WITH debit AS ("
+            "  UPDATE wallets SET money = money - :a1"
+            "  WHERE user_id = :f AND money >= :a2 RETURNING user_id), "
+            "credit AS ("
+            "  INSERT INTO wallets(user_id, money, held_money)"
+            "  SELECT :t, :a3, 0 FROM debit"
+            "  ON CONFLICT (user_id) DO UPDATE"
+            "  SET money = wallets.money + EXCLUDED.money RETURNING user_id) "
+            "SELECT count(*) FROM credit",
+        soci::use(amount, "a1"), soci::use(from_user_id, "f"),
+        soci::use(amount, "a2"), soci::use(to_user_id, "t"),
+        soci::use(amount, "a3"), soci::into(credited);
+    if (credited == 0) {
+      SPDLOG_WARN("transferLocal: Insufficient funds or user not found. "
+                  "user_id={}, amount={}",
+                  from_user_id, amount);
+      return false;
     }
-    SPDLOG_INFO("rollbackTransfer success: user_id={}, is_deduct={}", user_id,
-                is_deduct);
+    SPDLOG_DEBUG("transferLocal success: {} -> {}, amount={}", from_user_id,
+                 to_user_id, amount);
     return true;
   } catch (const std::exception &e) {
-    SPDLOG_ERROR("rollbackTransfer error: {}", e.what());
+    SPDLOG_ERROR("transferLocal error: {}", e.what());
     return false;
   }
-}
\ No newline at end of file
+}
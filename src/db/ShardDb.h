@@ -1,19 +1,55 @@
 // src/db/ShardDb.h
 #pragma once
 #include "models.h"
+#include <cstddef>
+#include <functional>
 #include <soci/soci.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class ShardDb {
 public:
   explicit ShardDb(const std::string &conninfo);
+  // 커넥션 풀에서 세션을 빌려 사용 (파괴 시 반납). 끊겨 있으면 재연결한다.
+  explicit ShardDb(soci::connection_pool &pool);
+
+  soci::session &session() { return sql_; }
 
   bool insertMessage(long long room_id, int user_id,
                      const std::string &content);
+  // 여러 메시지를 multi-row INSERT 한 번(왕복 1회, 트랜잭션 1회)으로 저장.
+  // 성공 시 msgs 마다 생성된 id 와 created_us 를 채운다 (shard_id 는 호출자 몫)
+  bool insertMessages(std::vector<db::Message> &msgs);
+  // 방 전체를 오래된 순으로 읽는다. 큰 방은 streamMessages 를 쓸 것.
   std::vector<db::Message> getMessages(long long room_id);
 
+  // 최신 → 과거 순 한 페이지. before_id 보다 작은 id 만 (0 이하면 최신부터).
+  // 다음 페이지는 결과의 마지막 id 를 before_id 로 넘긴다 (keyset, OFFSET 없음).
+  // messages(room_id, id) 인덱스를 탄다.
+  static constexpr std::size_t max_page_size = 1000;
+  std::vector<db::Message> getMessagesPage(long long room_id,
+                                           db::MessageId before_id,
+                                           std::size_t limit);
+
+  // 여러 샤드를 합치는 방 히스토리용 페이지 (created_at, id) 내림차순.
+  // before_us 가 0 이하면 최신부터, 아니면 (created_at, id) < (before_us, before_id).
+  // messages(room_id, created_at, id) 인덱스를 탄다.
+  std::vector<db::Message> getMessagesBefore(long long room_id,
+                                             long long before_us,
+                                             db::MessageId before_id,
+                                             std::size_t limit);
+
+  // after_id 이후 메시지를 오래된 순으로 batch_size 개씩 읽어 on_batch 에 넘긴다.
+  // 배치마다 별도 keyset 쿼리이므로 한 번에 batch_size 개만 메모리에 있다.
+  // on_batch 가 false 를 반환하면 중단. DB 오류면 false.
+  using BatchCallback = std::function<bool(const std::vector<db::Message> &)>;
+  bool streamMessages(long long room_id, db::MessageId after_id,
+                      std::size_t batch_size, const BatchCallback &on_batch);
+
   // TCC for Wallet
+  // 각 단계는 (tx_id, user_id) 기준으로 멱등이다 (transfer_log). 재시도/복구에서
+  // 같은 호출을 반복해도 한 번만 반영되고, cancel 뒤에 도착한 try 는 거부된다.
   std::optional<db::Wallet> getWallet(int user_id);
   bool prepareTransfer(int user_id, int amount, bool is_deduct,
                        const std::string &tx_id);
@@ -22,6 +58,30 @@ public:
   bool rollbackTransfer(int user_id, int amount, bool is_deduct,
                         const std::string &tx_id);
 
+  // 여러 참여자를 한 번에 (이 샤드의 parts 만). 유저별로 상계해 multi-row 문장
+  // 하나로 처리한다: max(0, 보내는 합계 - 받는 합계)를 예약하고, confirm 에서
+  // 예약을 풀며 (받는 합계 - 보내는 합계)를 반영한다.
+  // held 에는 try 가 기록된 유저별 실제 예약액 (잔액 부족이면 0). DB 오류면 false.
+  bool prepareTransfers(const std::string &tx_id,
+                        const std::vector<db::TransactionPart> &parts,
+                        std::unordered_map<int, int> &held);
+  // 모든 유저가 confirm 되었으면 true
+  bool commitTransfers(const std::string &tx_id,
+                       const std::vector<db::TransactionPart> &parts);
+  bool rollbackTransfers(const std::string &tx_id,
+                         const std::vector<db::TransactionPart> &parts);
+
+  // 같은 샤드 유저 간 이체. 차감/입금(지갑 없으면 생성)을 문장 하나로 실행하므로
+  // 그대로 원자적이다 (TCC 불필요, 왕복 1회). 잔액 부족이면 false.
+  bool transferLocal(int from_user_id, int to_user_id, int amount);
+
 private:
+  // 컬럼을 벡터로 한 번에 받는다 (행마다 values/rowset 변환 없음).
+  // query 는 FROM 절부터. created_us 가 있으면 :t 로 바인딩한다
+  bool fetchMessages(const std::string &query, long long room_id,
+                     db::MessageId key, std::size_t limit,
+                     std::vector<db::Message> &out,
+                     const long long *created_us = nullptr);
+
   soci::session sql_;
 };
\ No newline at end of file
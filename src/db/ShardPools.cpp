@@ -0,0 +1,119 @@
+// src/db/ShardPools.cpp
+#include "ShardPools.h"
+#include "SpdlogLoggerImpl.h"
+#include <soci/postgresql/soci-postgresql.h>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+ShardPools::Pool::Pool(std::size_t size, const std::string &conninfo)
+    : conninfo(conninfo), pool(size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    soci::session &sql = pool.at(i);
+    sql.open(soci::postgresql, conninfo);
+    soci::logger slog(new SpdlogLoggerImpl());
+    sql.set_logger(slog);
+  }
+}
+
+ShardPools::ShardPools(std::size_t pool_size,
+                       std::chrono::seconds health_interval)
+    : pool_size_(pool_size == 0 ? 1 : pool_size),
+      health_interval_(health_interval) {
+  if (health_interval_.count() > 0)
+    health_thread_ = std::thread([this] { runHealth(); });
+}
+
+ShardPools::~ShardPools() {
+  {
+    std::lock_guard<std::mutex> lock(health_mutex_);
+    stopping_ = true;
+  }
+  health_cv_.notify_one();
+  if (health_thread_.joinable())
+    health_thread_.join();
+}
+
+std::shared_ptr<ShardPools::Pool>
+ShardPools::getPool(const db::ShardInfo &info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pools_.find(info.id);
+    // conninfo 가 바뀌었으면(샤드 이전 등) 풀을 새로 만든다
+    if (it != pools_.end() && it->second->conninfo == info.conninfo)
+      return it->second;
+  }
+
+  // 커넥션 pool_size_ 개를 여는 동안 다른 샤드 요청이 막히지 않도록 락 밖에서
+  SPDLOG_INFO("ShardPools: open pool for shard {} ({}), size={}", info.id,
+              info.name, pool_size_);
+  std::shared_ptr<Pool> pool;
+  try {
+    pool = std::make_shared<Pool>(pool_size_, info.conninfo);
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("ShardPools: shard {} pool open failed: {}", info.id,
+                 e.what());
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &slot = pools_[info.id];
+  // 그 사이 다른 스레드가 같은 conninfo 로 먼저 열었으면 그쪽을 쓴다
+  if (slot && slot->conninfo == info.conninfo)
+    return slot;
+  slot = pool;
+  return pool;
+}
+
+std::shared_ptr<ShardDb> ShardPools::acquire(const db::ShardInfo &info) {
+  auto pool = getPool(info);
+  if (!pool)
+    return nullptr;
+  try {
+    // 삭제자가 풀을 붙잡고 있어 ShardDb 가 살아있는 동안 풀도 유지된다
+    return std::shared_ptr<ShardDb>(new ShardDb(pool->pool),
+                                    [pool](ShardDb *p) { delete p; });
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("ShardPools: shard {} acquire failed: {}", info.id, e.what());
+    return nullptr;
+  }
+}
+
+void ShardPools::checkHealth() {
+  std::vector<std::shared_ptr<Pool>> pools;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &[id, pool] : pools_)
+      pools.push_back(pool);
+  }
+  for (auto &pool : pools) {
+    // 사용 중인 커넥션은 건너뛰고 지금 놀고 있는 것만 빌려서 점검
+    std::vector<std::size_t> leased;
+    std::size_t pos = 0;
+    while (leased.size() < pool_size_ && pool->pool.try_lease(pos, 0))
+      leased.push_back(pos);
+
+    for (auto p : leased) {
+      try {
+        soci::session &sql = pool->pool.at(p);
+        if (!sql.is_connected()) {
+          SPDLOG_WARN("ShardPools: reconnect {}", pool->conninfo);
+          sql.reconnect();
+        }
+      } catch (const std::exception &e) {
+        SPDLOG_ERROR("ShardPools: reconnect failed: {}", e.what());
+      }
+    }
+    for (auto p : leased)
+      pool->pool.give_back(p);
+  }
+}
+
+void ShardPools::runHealth() {
+  std::unique_lock<std::mutex> lock(health_mutex_);
+  while (!health_cv_.wait_for(lock, health_interval_,
+                              [this] { return stopping_; })) {
+    lock.unlock();
+    checkHealth();
+    lock.lock();
+  }
+}
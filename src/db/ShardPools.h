@@ -0,0 +1,53 @@
+// src/db/ShardPools.h
+#pragma once
+#include "ShardDb.h"
+#include "models.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <soci/soci.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// 샤드별 soci::connection_pool 레지스트리.
+// shard id 로 처음 요청될 때 풀을 만들고 이후 계속 재사용한다.
+// health_interval 마다 백그라운드 스레드가 checkHealth() 를 실행한다 (0 이면 끔).
+class ShardPools {
+public:
+  explicit ShardPools(std::size_t pool_size,
+                      std::chrono::seconds health_interval =
+                          std::chrono::seconds(0));
+  ~ShardPools();
+
+  ShardPools(const ShardPools &) = delete;
+  ShardPools &operator=(const ShardPools &) = delete;
+
+  // 샤드 풀에서 세션을 빌린 ShardDb. 반환된 포인터가 파괴될 때 반납된다.
+  // 빌릴 때 끊긴 커넥션이면 재연결한다. 풀 생성 실패 시 nullptr.
+  std::shared_ptr<ShardDb> acquire(const db::ShardInfo &info);
+
+  // 놀고 있는 커넥션을 점검해 끊긴 것은 재연결
+  void checkHealth();
+
+private:
+  struct Pool {
+    Pool(std::size_t size, const std::string &conninfo);
+    std::string conninfo;
+    soci::connection_pool pool;
+  };
+
+  std::shared_ptr<Pool> getPool(const db::ShardInfo &info);
+  void runHealth();
+
+  std::size_t pool_size_;
+  std::mutex mutex_;
+  std::unordered_map<db::ShardId, std::shared_ptr<Pool>> pools_;
+
+  std::chrono::seconds health_interval_;
+  std::mutex health_mutex_;
+  std::condition_variable health_cv_;
+  bool stopping_ = false;
+  std::thread health_thread_;
+};
@@ -1,7 +1,10 @@
 #pragma once
 #include <soci/soci.h>
 #include <spdlog/spdlog.h>
+#include "QueryLog.h"
 
+// 쿼리/파라미터 본문은 TRACE 로만 남긴다 (기본 빌드에서는 컴파일 단계에서 제거).
+// 시간 측정과 샘플링/slow query 로그는 QueryTimer 가 담당.
 class SpdlogLoggerImpl : public soci::logger_impl {
 public:
     SpdlogLoggerImpl() {}
@@ -15,14 +18,15 @@ public:
     }
 
     void start_query(std::string const &query) override {
-        spdlog::info("SOCI query: {}", query);
+        querylog::lastQuery() = query;
+        SPDLOG_TRACE("SOCI query: {}", query);
     }
 
     void add_query_parameter(std::string name, std::string value) override {
-        spdlog::info("  param {} = {}", name, value);
+        SPDLOG_TRACE("  param {} = {}", name, value);
     }
 
     void clear_query_parameters() override {
-        spdlog::debug("  clear query params");
+        SPDLOG_TRACE("  clear query params");
     }
 };
\ No newline at end of file
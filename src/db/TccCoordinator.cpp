@@ -0,0 +1,320 @@
+// src/db/TccCoordinator.cpp
+#include "TccCoordinator.h"
+#include "AccountDb.h"
+#include "ShardDb.h"
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <spdlog/spdlog.h>
+
+TccCoordinator::TccCoordinator(DbRouter &router, const TccOptions &opts)
+    : router_(router), opts_(opts) {
+  std::size_t threads = std::max<std::size_t>(1, opts_.threads);
+  workers_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i)
+    workers_.emplace_back([this] { run(); });
+  // 이전 프로세스가 남긴 미완료 트랜잭션부터
+  schedule(Job{}, Clock::now());
+}
+
+TccCoordinator::~TccCoordinator() { stop(); }
+
+void TccCoordinator::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+      return;
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto &t : workers_) {
+    if (t.joinable())
+      t.join();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!active_.empty())
+    SPDLOG_WARN("TccCoordinator: stopped with {} unfinished transactions",
+                active_.size());
+  queue_.clear();
+  active_.clear();
+}
+
+std::size_t TccCoordinator::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_.size();
+}
+
+std::string TccCoordinator::prepare(const std::vector<db::TransactionPart> &parts,
+                                    HeldMap &held) {
+  held.clear();
+  if (parts.empty())
+    return "";
+  // 1. 참여자와 함께 글로벌 트랜잭션 기록 (PENDING)
+  std::string tx_id = router_.getAccountDb()->startTransaction(parts);
+  if (tx_id.empty()) {
+    SPDLOG_ERROR("TccCoordinator: failed to start transaction");
+    return "";
+  }
+
+  // 2. Try - 샤드별 multi-row 한 번, 모든 샤드에 동시에
+  std::map<db::ShardId, std::vector<db::TransactionPart>> by_shard;
+  for (auto &part : parts)
+    by_shard[part.shard_id].push_back(part);
+
+  auto tryShard = [this, &tx_id](db::ShardId shard_id,
+                                 const std::vector<db::TransactionPart> &group,
+                                 std::unordered_map<int, int> &out) {
+    auto shard = router_.getShard(shard_id);
+    if (!shard) {
+      SPDLOG_ERROR("TccCoordinator: failed to connect to shard {}", shard_id);
+      return false;
+    }
+    return shard->prepareTransfers(tx_id, group, out);
+  };
+  std::vector<std::unordered_map<int, int>> results(by_shard.size());
+  std::vector<std::future<bool>> others;
+  auto it = by_shard.begin();
+  for (std::size_t i = 1; i < by_shard.size(); ++i) {
+    ++it;
+    others.push_back(std::async(std::launch::async, tryShard, it->first,
+                                std::cref(it->second), std::ref(results[i])));
+  }
+  std::vector<bool> ok(by_shard.size());
+  ok[0] = tryShard(by_shard.begin()->first, by_shard.begin()->second,
+                   results[0]);
+  for (std::size_t i = 1; i < by_shard.size(); ++i)
+    ok[i] = others[i - 1].get();
+
+  std::size_t i = 0;
+  for (auto &[shard_id, group] : by_shard) {
+    if (ok[i])
+      held[shard_id] = std::move(results[i]);
+    ++i;
+  }
+  return tx_id;
+}
+
+bool TccCoordinator::execute(const std::vector<db::TransactionPart> &parts) {
+  if (parts.empty())
+    return false;
+
+  HeldMap held;
+  std::string tx_id = prepare(parts, held);
+  if (tx_id.empty())
+    return false;
+
+  // 모든 참여자가 요청한 만큼 예약했는지
+  bool prepared = std::all_of(
+      parts.begin(), parts.end(), [&](const db::TransactionPart &part) {
+        auto shard = held.find(part.shard_id);
+        if (shard == held.end())
+          return false;
+        auto user = shard->second.find(part.user_id);
+        return user != shard->second.end() &&
+               (!part.is_deduct || user->second == part.amount);
+      });
+
+  // 3. 결정 기록. 여기까지가 동기 구간이고 Confirm/Cancel 은 백그라운드
+  if (prepared && router_.getAccountDb()->commitTransaction(tx_id)) {
+    Job job;
+    job.tx_id = tx_id;
+    job.confirm = true;
+    job.parts = parts;
+    schedule(std::move(job), Clock::now());
+    SPDLOG_INFO("TccCoordinator: confirmed tx_id={}", tx_id);
+    return true;
+  }
+
+  // commitTransaction 실패는 실제로 CONFIRMED 가 기록됐을 수도 있다. cancel 은
+  // PENDING → CANCELED 전이가 성공해야만 샤드를 되돌리므로 confirm 과 cancel 이
+  // 둘 다 반영되는 일은 없다 (기록돼 있었다면 복구 스캔이 confirm 으로 이어간다)
+  SPDLOG_WARN("TccCoordinator: canceling tx_id={} (prepared={})", tx_id,
+              prepared);
+  cancel(tx_id, parts);
+  return false;
+}
+
+TccCoordinator::Outcome
+TccCoordinator::confirm(const std::string &tx_id,
+                        std::vector<db::TransactionPart> parts,
+                        std::vector<db::TransactionPart> prepared) {
+  if (!router_.getAccountDb()->commitTransaction(tx_id, parts)) {
+    // 취소 전이가 성공해야 확정되지 않은 것이 확실하다
+    if (cancel(tx_id, std::move(prepared)))
+      return Outcome::Canceled;
+    SPDLOG_WARN("TccCoordinator: outcome unknown tx_id={}", tx_id);
+    return Outcome::Unknown;
+  }
+  Job job;
+  job.tx_id = tx_id;
+  job.confirm = true;
+  job.parts = std::move(parts);
+  SPDLOG_INFO("TccCoordinator: confirmed tx_id={} parts={}", tx_id,
+              job.parts.size());
+  schedule(std::move(job), Clock::now());
+  return Outcome::Confirmed;
+}
+
+bool TccCoordinator::cancel(const std::string &tx_id,
+                            std::vector<db::TransactionPart> parts) {
+  // 취소 결정이 기록된 뒤에만 샤드를 되돌린다. 기록 실패(PENDING 으로 남음)는
+  // 복구 스캔이 recover_after 뒤에 취소로 결정하고 이어서 처리한다
+  if (!router_.getAccountDb()->cancelTransaction(tx_id)) {
+    SPDLOG_WARN("TccCoordinator: cancel not recorded, left to recovery "
+                "tx_id={}",
+                tx_id);
+    return false;
+  }
+  Job job;
+  job.tx_id = tx_id;
+  job.confirm = false;
+  job.parts = std::move(parts);
+  schedule(std::move(job), Clock::now());
+  return true;
+}
+
+void TccCoordinator::schedule(Job job, Clock::time_point due) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+      return;
+    if (!job.tx_id.empty())
+      active_.insert(job.tx_id);
+    queue_.emplace(due, std::move(job));
+  }
+  cv_.notify_one();
+}
+
+void TccCoordinator::run() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      for (;;) {
+        if (stopping_)
+          return;
+        if (queue_.empty()) {
+          cv_.wait(lock);
+          continue;
+        }
+        auto due = queue_.begin()->first;
+        if (due <= Clock::now())
+          break;
+        cv_.wait_until(lock, due);
+      }
+      job = std::move(queue_.begin()->second);
+      queue_.erase(queue_.begin());
+    }
+    try {
+      process(std::move(job));
+    } catch (const std::exception &e) {
+      SPDLOG_ERROR("TccCoordinator: job error: {}", e.what());
+    }
+  }
+}
+
+void TccCoordinator::process(Job job) {
+  if (job.tx_id.empty()) {
+    scan();
+    if (opts_.scan_interval.count() > 0)
+      schedule(Job{}, Clock::now() + opts_.scan_interval);
+    return;
+  }
+
+  // 샤드별로 한 번에. 성공한 샤드의 참여자는 빼고 남은 것만 재시도
+  std::map<db::ShardId, std::vector<db::TransactionPart>> by_shard;
+  for (auto &part : job.parts)
+    by_shard[part.shard_id].push_back(part);
+  job.parts.clear();
+  for (auto &[shard_id, group] : by_shard) {
+    if (!applyShard(job.tx_id, shard_id, group, job.confirm))
+      job.parts.insert(job.parts.end(), group.begin(), group.end());
+  }
+
+  if (job.parts.empty() && finish(job.tx_id, job.confirm)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_.erase(job.tx_id);
+    return;
+  }
+
+  // 실패한 참여자만 남겨 재시도 (confirm 은 결정된 이상 포기하지 않는다)
+  auto delay = backoff(job.attempt++);
+  SPDLOG_WARN("TccCoordinator: {} retry tx_id={} attempt={} remaining={} in {}ms",
+              job.confirm ? "confirm" : "cancel", job.tx_id, job.attempt,
+              job.parts.size(), delay.count());
+  schedule(std::move(job), Clock::now() + delay);
+}
+
+bool TccCoordinator::applyShard(const std::string &tx_id, db::ShardId shard_id,
+                                const std::vector<db::TransactionPart> &parts,
+                                bool confirm) {
+  auto shard = router_.getShard(shard_id);
+  if (!shard)
+    return false;
+  return confirm ? shard->commitTransfers(tx_id, parts)
+                 : shard->rollbackTransfers(tx_id, parts);
+}
+
+bool TccCoordinator::finish(const std::string &tx_id, bool confirm) {
+  return router_.getAccountDb()->finishTransaction(
+      tx_id, confirm ? db::TransactionStatus::COMMITTED
+                     : db::TransactionStatus::ROLLED_BACK);
+}
+
+std::chrono::milliseconds TccCoordinator::backoff(int attempt) const {
+  auto delay = opts_.retry_min;
+  for (int i = 0; i < attempt && delay < opts_.retry_max; ++i)
+    delay *= 2;
+  return std::min(delay, opts_.retry_max);
+}
+
+void TccCoordinator::scan() {
+  auto accountDb = router_.getAccountDb();
+  auto txs =
+      accountDb->getUnfinishedTransactions(opts_.recover_after, opts_.scan_limit);
+  std::size_t resumed = 0;
+  for (auto &tx : txs) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_)
+        return;
+      if (active_.count(tx.id))
+        continue; // 이 프로세스가 처리 중
+    }
+
+    Job job;
+    job.tx_id = tx.id;
+    switch (static_cast<db::TransactionStatus>(tx.status)) {
+    case db::TransactionStatus::PENDING:
+      // 결정 전에 멈춘 건은 취소로 결정. 그 사이 다른 노드가 CONFIRMED 로
+      // 바꿨다면 실패하고 다음 스캔에서 confirm 으로 이어진다
+      if (!accountDb->cancelTransaction(tx.id))
+        continue;
+      job.confirm = false;
+      break;
+    case db::TransactionStatus::CONFIRMED:
+      job.confirm = true;
+      break;
+    case db::TransactionStatus::CANCELED:
+      job.confirm = false;
+      break;
+    default:
+      continue;
+    }
+
+    auto parts = accountDb->getTransactionParts(tx.id);
+    if (!parts)
+      continue;
+    if (parts->empty()) {
+      // transaction_parts 도입 전 트랜잭션: 샤드에 할 일을 알 수 없다
+      SPDLOG_WARN("TccCoordinator: tx_id={} has no parts, closing", tx.id);
+      finish(tx.id, job.confirm);
+      continue;
+    }
+    job.parts = std::move(*parts);
+    schedule(std::move(job), Clock::now());
+    ++resumed;
+  }
+  if (resumed > 0)
+    SPDLOG_INFO("TccCoordinator: resumed {} unfinished transactions", resumed);
+}
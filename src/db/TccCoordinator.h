@@ -0,0 +1,97 @@
+// src/db/TccCoordinator.h
+#pragma once
+#include "DbOptions.h"
+#include "DbRouter.h"
+#include "models.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 샤드 간 송금의 TCC 코디네이터.
+//
+// execute() 는 Try 를 모든 참여 샤드에 동시에 보내고, 결정(CONFIRMED /
+// CANCELED)을 account DB 에 기록한 뒤 바로 반환한다. 샤드별 Confirm/Cancel 은
+// 백그라운드 워커가 성공할 때까지 재시도(지수 백오프)하고, 모두 끝나면
+// COMMITTED / ROLLED_BACK 으로 닫는다.
+//
+// 샤드 단계는 tx_id 기준으로 멱등(transfer_log)이라 여러 번 실행해도 되므로,
+// 프로세스가 중간에 죽어도 복구 스캔(시작 시 + 주기적)이 이어서 처리한다.
+//  - PENDING   : 결정 전에 멈춘 건 → CANCELED 로 결정 후 cancel
+//  - CONFIRMED : confirm 재개
+//  - CANCELED  : cancel 재개
+class TccCoordinator {
+public:
+  TccCoordinator(DbRouter &router, const TccOptions &opts);
+  ~TccCoordinator();
+
+  TccCoordinator(const TccCoordinator &) = delete;
+  TccCoordinator &operator=(const TccCoordinator &) = delete;
+
+  // Try + 결정까지 동기로 실행. true 면 확정(confirm 은 백그라운드), false 면 취소.
+  // parts 의 tx_id 는 무시한다.
+  bool execute(const std::vector<db::TransactionPart> &parts);
+
+  // 단계를 나눠 쓰는 API (TransferBatcher): Try 결과를 보고 참여자를 조정한 뒤
+  // confirm / cancel 한다. 샤드별 Try 는 multi-row 문장 하나(ShardDb::prepareTransfers)
+  //
+  // 결정 결과. Unknown 은 결정 기록 여부를 알 수 없는 경우 (CONFIRMED 기록이
+  // 실패로 보였는데 취소 기록도 실패). 복구 스캔이 어느 쪽이든 마무리한다
+  enum class Outcome { Confirmed, Canceled, Unknown };
+  // shard_id → (user_id → 실제 예약액). Try 가 실패한 샤드는 빠진다
+  using HeldMap =
+      std::unordered_map<db::ShardId, std::unordered_map<int, int>>;
+  // 트랜잭션 기록 + 모든 샤드에 Try. 기록 실패면 빈 문자열
+  std::string prepare(const std::vector<db::TransactionPart> &parts,
+                      HeldMap &held);
+  // parts 를 최종 참여자로 바꿔 CONFIRMED 기록 후 백그라운드 confirm.
+  // 결정 기록에 실패하면 prepared(prepare 에 넘긴 parts) 전체를 cancel 한다
+  Outcome confirm(const std::string &tx_id,
+                  std::vector<db::TransactionPart> parts,
+                  std::vector<db::TransactionPart> prepared);
+  // prepare 에 넘긴 parts 전체를 백그라운드 cancel. 취소 기록에 실패하면 false
+  // (PENDING 으로 남아 복구 스캔이 취소한다)
+  bool cancel(const std::string &tx_id, std::vector<db::TransactionPart> parts);
+
+  // 큐에 남은 작업은 버린다 (다음 시작 시 복구 스캔이 처리)
+  void stop();
+
+  // 진행 중인 백그라운드 confirm/cancel 수
+  std::size_t pending() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    std::string tx_id;                    // 비어 있으면 복구 스캔
+    bool confirm = false;
+    std::vector<db::TransactionPart> parts; // 아직 처리 못 한 참여자
+    int attempt = 0;
+  };
+
+  void schedule(Job job, Clock::time_point due);
+  void run();
+  void process(Job job);
+  void scan();
+  // 샤드 하나의 참여자들에 confirm/cancel (멱등)
+  bool applyShard(const std::string &tx_id, db::ShardId shard_id,
+                  const std::vector<db::TransactionPart> &parts, bool confirm);
+  // 모든 참여자 처리 후 COMMITTED / ROLLED_BACK 기록
+  bool finish(const std::string &tx_id, bool confirm);
+  std::chrono::milliseconds backoff(int attempt) const;
+
+  DbRouter &router_;
+  TccOptions opts_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::multimap<Clock::time_point, Job> queue_; // 실행 시각 순
+  std::unordered_set<std::string> active_;      // 큐/실행 중인 tx_id
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
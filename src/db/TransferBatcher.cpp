@@ -0,0 +1,196 @@
+// src/db/TransferBatcher.cpp
+#include "TransferBatcher.h"
+#include <map>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+TransferBatcher::TransferBatcher(TccCoordinator &tcc)
+    : TransferBatcher(tcc, TransferBatchOptions{}) {}
+
+TransferBatcher::TransferBatcher(TccCoordinator &tcc, TransferBatchOptions opts)
+    : tcc_(tcc), opts_(opts), thread_([this] { run(); }) {}
+
+TransferBatcher::~TransferBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+void TransferBatcher::enqueue(const Transfer &transfer, Callback done) {
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(Pending{transfer, std::move(done)});
+    // 첫 송금(타이머 시작) 또는 배치가 찼을 때만 깨운다
+    notify = queue_.size() == 1 || queue_.size() >= opts_.max_batch;
+  }
+  if (notify)
+    cv_.notify_one();
+}
+
+void TransferBatcher::run() {
+  std::vector<Pending> batch;
+  batch.reserve(opts_.max_batch);
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty())
+        return; // stopping
+
+      // 첫 송금 기준 max_delay 까지 더 모은다
+      auto deadline = std::chrono::steady_clock::now() + opts_.max_delay;
+      cv_.wait_until(lock, deadline, [&] {
+        return stopping_ || queue_.size() >= opts_.max_batch;
+      });
+
+      while (!queue_.empty() && batch.size() < opts_.max_batch) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+    }
+    flush(batch);
+    batch.clear();
+  }
+}
+
+using ParticipantKey = std::pair<db::ShardId, int>;
+
+// (샤드, 유저) 별로 accepted 송금의 보낸 합계 / 받은 합계를 참여자로 만든다.
+// participants 의 유저는 accepted 에 없어도 금액 0 의 입금 참여자로 남긴다
+// (confirm 에서 Try 예약을 풀어야 하므로). 샤드에서 유저별로 상계된다
+static std::vector<db::TransactionPart>
+netParts(const std::vector<TransferBatcher::Transfer> &participants,
+         const std::vector<TransferBatcher::Transfer> &accepted) {
+  std::map<ParticipantKey, std::pair<int, int>> totals;
+  for (auto &t : participants) {
+    totals[{t.from_shard, t.from_user_id}];
+    totals[{t.to_shard, t.to_user_id}];
+  }
+  for (auto &t : accepted) {
+    totals[{t.from_shard, t.from_user_id}].first += t.amount;
+    totals[{t.to_shard, t.to_user_id}].second += t.amount;
+  }
+
+  std::vector<db::TransactionPart> parts;
+  parts.reserve(totals.size());
+  for (auto &[key, sum] : totals) {
+    db::TransactionPart part;
+    part.shard_id = key.first;
+    part.user_id = key.second;
+    if (sum.first > 0) {
+      part.amount = sum.first;
+      part.is_deduct = true;
+      parts.push_back(part);
+    }
+    if (sum.second > 0 || sum.first == 0) {
+      part.amount = sum.second;
+      part.is_deduct = false;
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+static std::optional<int> heldOf(const TccCoordinator::HeldMap &held,
+                                 db::ShardId shard_id, int user_id) {
+  auto shard = held.find(shard_id);
+  if (shard == held.end())
+    return std::nullopt;
+  auto user = shard->second.find(user_id);
+  if (user == shard->second.end())
+    return std::nullopt;
+  return user->second;
+}
+
+// 예약은 유저별로 상계액 전부 아니면 0 이다. 받기로 한 송금이 빠지면 보내는 쪽
+// 상계액이 커질 수 있으므로, 모든 송신자의 상계액이 예약 안에 들어올 때까지
+// 예약이 모자란 송신자의 송금을 전부 뺀다 (빠지기만 하므로 반드시 끝난다)
+static std::vector<bool>
+acceptWithinHolds(const std::vector<TransferBatcher::Transfer> &transfers,
+                  const TccCoordinator::HeldMap &held) {
+  std::vector<bool> ok(transfers.size(), true);
+  for (bool changed = true; changed;) {
+    changed = false;
+    std::map<ParticipantKey, int> out; // 보낸 합계 - 받은 합계
+    for (std::size_t i = 0; i < transfers.size(); ++i) {
+      if (!ok[i])
+        continue;
+      auto &t = transfers[i];
+      out[{t.from_shard, t.from_user_id}] += t.amount;
+      out[{t.to_shard, t.to_user_id}] -= t.amount;
+    }
+    for (std::size_t i = 0; i < transfers.size(); ++i) {
+      auto &t = transfers[i];
+      if (!ok[i])
+        continue;
+      int need = out[{t.from_shard, t.from_user_id}];
+      if (need > heldOf(held, t.from_shard, t.from_user_id).value_or(0)) {
+        ok[i] = false;
+        changed = true;
+      }
+    }
+  }
+  return ok;
+}
+
+void TransferBatcher::flush(std::vector<Pending> &batch) {
+  using Outcome = TccCoordinator::Outcome;
+  auto finish = [&](const std::vector<bool> &ok, Outcome outcome) {
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      if (batch[i].done)
+        batch[i].done(ok[i] ? outcome : Outcome::Canceled);
+    }
+  };
+  std::vector<bool> none(batch.size(), false);
+
+  std::vector<Transfer> transfers;
+  transfers.reserve(batch.size());
+  for (auto &p : batch)
+    transfers.push_back(p.transfer);
+  auto parts = netParts(transfers, transfers);
+
+  TccCoordinator::HeldMap held;
+  std::string tx_id = tcc_.prepare(parts, held);
+  if (tx_id.empty()) {
+    finish(none, Outcome::Canceled);
+    return;
+  }
+
+  // Try 가 기록되지 않은 참여자가 있으면 (샤드 오류) 배치 전체를 취소.
+  // 취소 기록이 실패해도 confirm 할 주체가 없으므로 복구 스캔이 취소한다
+  for (auto &part : parts) {
+    if (!heldOf(held, part.shard_id, part.user_id)) {
+      SPDLOG_WARN("transfer batch: shard {} try failed, canceling tx_id={} "
+                  "({} transfers)",
+                  part.shard_id, tx_id, batch.size());
+      tcc_.cancel(tx_id, parts);
+      finish(none, Outcome::Canceled);
+      return;
+    }
+  }
+
+  auto ok = acceptWithinHolds(transfers, held);
+  std::vector<Transfer> accepted;
+  accepted.reserve(transfers.size());
+  for (std::size_t i = 0; i < transfers.size(); ++i) {
+    if (ok[i])
+      accepted.push_back(transfers[i]);
+  }
+  if (accepted.empty()) {
+    tcc_.cancel(tx_id, parts);
+    finish(none, Outcome::Canceled);
+    return;
+  }
+
+  auto outcome = tcc_.confirm(tx_id, netParts(transfers, accepted), parts);
+  SPDLOG_INFO("transfer batch: tx_id={} transfers={} accepted={} outcome={}",
+              tx_id, batch.size(), accepted.size(), static_cast<int>(outcome));
+  finish(ok, outcome);
+}
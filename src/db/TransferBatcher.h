@@ -0,0 +1,63 @@
+// src/db/TransferBatcher.h
+#pragma once
+#include "DbOptions.h"
+#include "TccCoordinator.h"
+#include "models.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 대량 소액 송금용 배치 (이벤트 보상 등).
+// enqueue 된 송금을 max_delay 동안 또는 max_batch 건까지 모아 글로벌 트랜잭션
+// 하나(TccCoordinator)로 처리한다.
+//  - 유저별로 보내는/받는 금액을 상계(netting)해 max(0, 보낸 합계 - 받은 합계)만
+//    예약하고 confirm 에서 차액을 반영한다. 샤드마다 multi-row 문장 하나로
+//    Try/Confirm 하므로 송금 수와 무관하게 샤드당 왕복은 단계별 1회
+//  - 예약이 모자란 유저가 보낸 송금만 실패하고 나머지는 같은 트랜잭션으로 확정.
+//    그 때문에 받을 돈이 줄어 예약이 모자라게 된 유저의 송금도 함께 실패한다
+//  - 결과는 송금별 콜백 (배치 스레드에서 호출). Confirmed 는 확정되었다는 뜻이고
+//    샤드 반영(confirm)은 백그라운드에서 끝난다. Unknown 은 결정 기록이 불확실한
+//    경우로, 복구 스캔이 확정 또는 취소로 마무리한다
+class TransferBatcher {
+public:
+  using Callback = std::function<void(TccCoordinator::Outcome outcome)>;
+
+  struct Transfer {
+    int from_user_id{};
+    db::ShardId from_shard{};
+    int to_user_id{};
+    db::ShardId to_shard{};
+    int amount{};
+  };
+
+  explicit TransferBatcher(TccCoordinator &tcc);
+  TransferBatcher(TccCoordinator &tcc, TransferBatchOptions opts);
+  // 남은 송금을 처리한 뒤 종료
+  ~TransferBatcher();
+
+  TransferBatcher(const TransferBatcher &) = delete;
+  TransferBatcher &operator=(const TransferBatcher &) = delete;
+
+  void enqueue(const Transfer &transfer, Callback done = nullptr);
+
+private:
+  struct Pending {
+    Transfer transfer;
+    Callback done;
+  };
+
+  void run();
+  void flush(std::vector<Pending> &batch);
+
+  TccCoordinator &tcc_;
+  TransferBatchOptions opts_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Pending> queue_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
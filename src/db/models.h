@@ -51,8 +51,34 @@ struct Message {
   std::string content;
   // std::chrono::system_clock::time_point created_at{};
   std::tm created_at{};
+  // 컬럼이 아닌 값: 저장/조회한 샤드와 created_at 의 epoch 마이크로초.
+  // id 는 샤드마다 따로 증가하므로 방 히스토리는 MessageCursor 순서를 쓴다
+  ShardId shard_id{};
+  long long created_us{};
 };
 
+// 여러 샤드에 걸친 방 히스토리의 keyset 커서: (created_us, shard_id, id) 순.
+// created_us 가 0 이면 "최신부터"
+struct MessageCursor {
+  long long created_us{};
+  ShardId shard_id{};
+  MessageId id{};
+
+  bool empty() const { return created_us == 0; }
+};
+
+inline MessageCursor cursorOf(const Message &m) {
+  return MessageCursor{m.created_us, m.shard_id, m.id};
+}
+
+inline bool operator<(const MessageCursor &a, const MessageCursor &b) {
+  if (a.created_us != b.created_us)
+    return a.created_us < b.created_us;
+  if (a.shard_id != b.shard_id)
+    return a.shard_id < b.shard_id;
+  return a.id < b.id;
+}
+
 // ========================
 // ChatRoom (chatdb_N.chat_rooms)
 // ========================
@@ -66,14 +92,37 @@ struct ChatRoom {
 // ========================
 // Transaction (account_db.transactions)
 // ========================
-enum class TransactionStatus : int { PENDING = 0, CONFIRMED = 1, CANCELED = 2 };
+// PENDING → CONFIRMED → COMMITTED  (모든 샤드 confirm 완료)
+//         → CANCELED  → ROLLED_BACK (모든 샤드 cancel 완료)
+// CONFIRMED/CANCELED 는 결정만 기록된 상태로, 코디네이터가 마저 진행한다.
+enum class TransactionStatus : int {
+  PENDING = 0,
+  CONFIRMED = 1,
+  CANCELED = 2,
+  COMMITTED = 3,
+  ROLLED_BACK = 4
+};
 
 struct Transaction {
   std::string id;
-  int status; // 0=PENDING, 1=CONFIRMED, 2=CANCELED
+  int status; // 0=PENDING, 1=CONFIRMED, 2=CANCELED, 3=COMMITTED, 4=ROLLED_BACK
   std::tm created_at{};
 };
 
+// ========================
+// TransactionPart (account_db.transaction_parts)
+// 트랜잭션 참여자. 복구 시 어느 샤드에 무엇을 confirm/cancel 할지 알 수 있게
+// 트랜잭션 시작과 함께 기록한다.
+// ========================
+struct TransactionPart {
+  std::string tx_id;
+  int part_no{};
+  int shard_id{};
+  int user_id{};
+  int amount{};
+  bool is_deduct{};
+};
+
 // ========================
 // Wallet (shard_db.wallets)
 // ========================
@@ -199,6 +248,31 @@ template <> struct type_conversion<db::Transaction> {
   }
 };
 
+// TransactionPart
+template <> struct type_conversion<db::TransactionPart> {
+  typedef values base_type;
+
+  static void from_base(values const &v, indicator, db::TransactionPart &p) {
+    p.tx_id = v.get<std::string>("tx_id");
+    p.part_no = v.get<int>("part_no");
+    p.shard_id = v.get<int>("shard_id");
+    p.user_id = v.get<int>("user_id");
+    p.amount = v.get<int>("amount");
+    p.is_deduct = v.get<int>("is_deduct") != 0;
+  }
+
+  static void to_base(const db::TransactionPart &p, values &v,
+                      indicator &ind) {
+    v.set("tx_id", p.tx_id);
+    v.set("part_no", p.part_no);
+    v.set("shard_id", p.shard_id);
+    v.set("user_id", p.user_id);
+    v.set("amount", p.amount);
+    v.set("is_deduct", p.is_deduct ? 1 : 0);
+    ind = i_ok;
+  }
+};
+
 // Wallet
 template <> struct type_conversion<db::Wallet> {
   typedef values base_type;
@@ -0,0 +1,350 @@
+// tools/loadgen/chat_loadgen.cpp
+// 채팅 서버 부하 생성기. io_mode(shared / per_core) 비교용.
+//
+// 클라이언트마다 framed 모드로 접속 → 로그인 → 방 입장 후 일정한 속도로 채팅을 보낸다.
+// 본문은 "lg <client> <seq> <send_ns>" (+ 패딩) 이라서, 같은 방 fan-out 으로 자기
+// 메시지가 돌아오면 왕복 지연을 잴 수 있다. 끝나면 송신/수신 처리량과 p50/p99 를 출력한다.
+//
+//   chat_loadgen --host 127.0.0.1 --port 12345 --clients 200 --rooms 20
+//                --rate 2000 --duration 30 --size 64 --user-prefix lg --password pw
+//
+// 로그인하려면 <user-prefix>0 .. <user-prefix>N-1 계정이 미리 있어야 한다.
+#include "protocol.h"
+
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace asio = boost::asio;
+using asio::ip::tcp;
+using steady = std::chrono::steady_clock;
+
+namespace {
+
+struct loadgen_options {
+    std::string host = "127.0.0.1";
+    std::string port = "12345";
+    std::size_t clients = 100;
+    std::size_t rooms = 10;
+    double rate = 1000;        // 전체 초당 송신 수
+    int duration = 30;         // 송신 시간 (초)
+    int drain = 2;             // 송신 종료 후 수신 대기 (초)
+    std::size_t size = 64;     // 본문 최소 길이 (패딩)
+    std::size_t threads = 1;   // 부하 생성기 io 스레드
+    std::string user_prefix = "lg";
+    std::string password = "pw";
+};
+
+long long now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               steady::now().time_since_epoch())
+        .count();
+}
+
+// 전체 결과. 클라이언트가 끝날 때 한 번씩만 합치므로 락 하나로 충분하다
+struct loadgen_stats {
+    std::atomic<std::uint64_t> sent{0};
+    std::atomic<std::uint64_t> received{0};    // 받은 채팅 프레임 전체 (fan-out 포함)
+    std::atomic<std::uint64_t> logged_in{0};
+    std::atomic<std::uint64_t> failed{0};
+
+    std::mutex mutex;
+    std::vector<long long> latencies_ns;       // 자기 메시지 왕복
+
+    void merge(std::vector<long long>& lat) {
+        std::lock_guard<std::mutex> lock(mutex);
+        latencies_ns.insert(latencies_ns.end(), lat.begin(), lat.end());
+    }
+};
+
+class loadgen_client : public std::enable_shared_from_this<loadgen_client> {
+public:
+    loadgen_client(asio::io_context& io, const loadgen_options& opts, loadgen_stats& stats,
+                   std::size_t index, steady::time_point start, steady::time_point stop)
+        : socket_(asio::make_strand(io)), timer_(socket_.get_executor()), opts_(opts),
+          stats_(stats), index_(index), start_(start), stop_(stop) {
+        double per_client = opts_.rate / static_cast<double>(opts_.clients);
+        interval_ = std::chrono::nanoseconds(
+            per_client > 0 ? static_cast<long long>(1e9 / per_client) : 0);
+    }
+
+    void run(const tcp::resolver::results_type& endpoints) {
+        auto self = shared_from_this();
+        asio::async_connect(socket_, endpoints, [this, self](boost::system::error_code ec, auto) {
+            if (ec) return fail("connect", ec);
+            socket_.set_option(tcp::no_delay(true));
+            static const char preamble[] = {static_cast<char>(protocol::frame_preamble),
+                                            static_cast<char>(protocol::protocol_version)};
+            send(std::string(preamble, sizeof(preamble)));
+            read_ack();
+        });
+    }
+
+    // 다른 스레드에서 불러도 된다 (클라이언트 strand 에서 실행)
+    void close() {
+        auto self = shared_from_this();
+        asio::dispatch(socket_.get_executor(), [this, self] {
+            stopped_ = true;
+            boost::system::error_code ec;
+            timer_.cancel();
+            socket_.close(ec);
+            stats_.merge(latencies_ns_);
+            latencies_ns_.clear();
+        });
+    }
+
+private:
+    // "+FRAMED 1\n" 까지는 텍스트. 서버는 접속 즉시 기본 방에 넣으므로
+    // ack 앞에 오는 환영 문구/기록 재생 줄은 읽고 버린다
+    void read_ack() {
+        auto self = shared_from_this();
+        asio::async_read_until(socket_, asio::dynamic_buffer(text_), '\n',
+                               [this, self](boost::system::error_code ec, std::size_t n) {
+            if (ec) return fail("handshake", ec);
+            std::string_view line(text_.data(), n - 1);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line != protocol::framed_ack) {
+                text_.erase(0, n);
+                return read_ack();
+            }
+            // ack 뒤에 붙어 온 바이트는 프레임 수신 버퍼로
+            auto rest = std::string_view(text_).substr(n);
+            auto buf = in_.prepare(rest.size());
+            std::memcpy(buf.data(), rest.data(), rest.size());
+            in_.commit(rest.size());
+            text_.clear();
+
+            send(protocol::encode_frame(protocol::frame_type::login,
+                                        opts_.user_prefix + std::to_string(index_) + " " +
+                                            opts_.password));
+            read_frames();
+        });
+    }
+
+    void read_frames() {
+        parse_frames();
+        auto self = shared_from_this();
+        socket_.async_read_some(in_.prepare(protocol::read_chunk_size),
+                                [this, self](boost::system::error_code ec, std::size_t n) {
+            if (ec) {
+                if (!stopped_) fail("read", ec);
+                return;
+            }
+            in_.commit(n);
+            read_frames();
+        });
+    }
+
+    void parse_frames() {
+        for (;;) {
+            auto data = in_.data();
+            if (data.size() < protocol::frame_header_size) return;
+            auto h = protocol::decode_header(data.data());
+            if (data.size() < protocol::frame_header_size + h.length) return;
+            on_frame(data.substr(protocol::frame_header_size, h.length));
+            in_.consume(protocol::frame_header_size + h.length);
+        }
+    }
+
+    void on_frame(std::string_view payload) {
+        if (!joined_) {
+            if (payload.rfind("Logged in as ", 0) == 0) {
+                ++stats_.logged_in;
+                joined_ = true;
+                auto room = 1 + index_ % std::max<std::size_t>(1, opts_.rooms);
+                send(protocol::encode_frame(protocol::frame_type::join, std::to_string(room)));
+                schedule_send(start_);
+            } else if (payload.rfind("Login failed", 0) == 0) {
+                fail("login", {});
+            }
+            return;
+        }
+        ++stats_.received;
+        // "lg <client> <seq> <ns>": 자기 메시지면 왕복 지연 기록.
+        // 입장 시 재생되는 이전 실행의 히스토리는 seq 가 이번 송신 범위를 벗어나 걸러진다
+        if (payload.rfind("lg ", 0) != 0) return;
+        long long fields[3] = {};
+        const char* p = payload.data() + 3;
+        const char* end = payload.data() + payload.size();
+        for (auto& f : fields) {
+            auto [ptr, ec] = std::from_chars(p, end, f);
+            if (ec != std::errc()) return;
+            p = ptr < end ? ptr + 1 : end;
+        }
+        if (fields[0] != static_cast<long long>(index_)) return;
+        if (fields[1] < 1 || fields[1] > static_cast<long long>(seq_)) return;
+        if (fields[2] < run_start_ns_) return;
+        latencies_ns_.push_back(now_ns() - fields[2]);
+    }
+
+    void schedule_send(steady::time_point at) {
+        if (interval_.count() == 0 || at >= stop_) return;
+        auto self = shared_from_this();
+        timer_.expires_at(at);
+        timer_.async_wait([this, self, at](boost::system::error_code ec) {
+            if (ec || stopped_) return;
+            send_chat();
+            // 밀렸으면 몰아 보내지 않고 지금부터 다시 간격을 잡는다
+            auto next = at + interval_;
+            schedule_send(std::max(next, steady::now()));
+        });
+    }
+
+    void send_chat() {
+        std::string body = "lg " + std::to_string(index_) + " " + std::to_string(++seq_) + " " +
+                           std::to_string(now_ns());
+        if (body.size() < opts_.size) body.append(opts_.size - body.size(), 'x');
+        send(protocol::encode_frame(protocol::frame_type::chat, body));
+        ++stats_.sent;
+    }
+
+    // 쓰기는 한 번에 하나. 나머지는 큐에서 차례로
+    void send(std::string data) {
+        out_.push_back(std::move(data));
+        if (out_.size() == 1) do_write();
+    }
+
+    void do_write() {
+        auto self = shared_from_this();
+        asio::async_write(socket_, asio::buffer(out_.front()),
+                          [this, self](boost::system::error_code ec, std::size_t) {
+            if (ec) {
+                if (!stopped_) fail("write", ec);
+                return;
+            }
+            out_.pop_front();
+            if (!out_.empty()) do_write();
+        });
+    }
+
+    void fail(const char* what, boost::system::error_code ec) {
+        if (stopped_) return;
+        stopped_ = true;
+        ++stats_.failed;
+        std::fprintf(stderr, "client %zu: %s failed%s%s\n", index_, what, ec ? ": " : "",
+                     ec ? ec.message().c_str() : "");
+        boost::system::error_code ignored;
+        timer_.cancel();
+        socket_.close(ignored);
+    }
+
+    // 핸들러는 모두 이 strand 에서 실행된다 (--threads > 1 이어도 클라이언트 상태는 단일 스레드)
+    tcp::socket socket_;
+    asio::steady_timer timer_;
+    const loadgen_options& opts_;
+    loadgen_stats& stats_;
+    std::size_t index_;
+    steady::time_point start_;
+    steady::time_point stop_;
+    std::chrono::nanoseconds interval_{};
+    long long run_start_ns_ = now_ns();
+
+    std::string text_;
+    protocol::read_buffer in_;
+    std::deque<std::string> out_;
+    bool joined_ = false;
+    bool stopped_ = false;
+    std::uint64_t seq_ = 0;
+    std::vector<long long> latencies_ns_;
+};
+
+bool parse_args(int argc, char** argv, loadgen_options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--host") opts.host = value;
+        else if (arg == "--port") opts.port = value;
+        else if (arg == "--clients") opts.clients = std::stoul(value);
+        else if (arg == "--rooms") opts.rooms = std::stoul(value);
+        else if (arg == "--rate") opts.rate = std::stod(value);
+        else if (arg == "--duration") opts.duration = std::stoi(value);
+        else if (arg == "--drain") opts.drain = std::stoi(value);
+        else if (arg == "--size") opts.size = std::stoul(value);
+        else if (arg == "--threads") opts.threads = std::stoul(value);
+        else if (arg == "--user-prefix") opts.user_prefix = value;
+        else if (arg == "--password") opts.password = value;
+        else return false;
+    }
+    return opts.clients > 0 && opts.threads > 0 && opts.duration > 0;
+}
+
+long long percentile(const std::vector<long long>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    auto i = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    loadgen_options opts;
+    try {
+        if (!parse_args(argc, argv, opts)) {
+            std::fprintf(stderr,
+                         "usage: %s [--host H] [--port P] [--clients N] [--rooms N] [--rate MSG/S]\n"
+                         "          [--duration SEC] [--drain SEC] [--size BYTES] [--threads N]\n"
+                         "          [--user-prefix PREFIX] [--password PW]\n",
+                         argv[0]);
+            return 2;
+        }
+    } catch (const std::exception&) {
+        std::fprintf(stderr, "invalid argument\n");
+        return 2;
+    }
+
+    asio::io_context io;
+    tcp::resolver resolver(io);
+    auto endpoints = resolver.resolve(opts.host, opts.port);
+
+    // 접속/로그인이 끝날 시간을 조금 두고 모든 클라이언트가 같은 시각에 송신을 시작한다
+    loadgen_stats stats;
+    auto start = steady::now() + std::chrono::seconds(1);
+    auto stop = start + std::chrono::seconds(opts.duration);
+    std::vector<std::shared_ptr<loadgen_client>> clients;
+    clients.reserve(opts.clients);
+    for (std::size_t i = 0; i < opts.clients; ++i) {
+        clients.push_back(std::make_shared<loadgen_client>(io, opts, stats, i, start, stop));
+        clients.back()->run(endpoints);
+    }
+
+    asio::steady_timer done(io, stop + std::chrono::seconds(opts.drain));
+    done.async_wait([&](boost::system::error_code) {
+        for (auto& c : clients) c->close();
+    });
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < opts.threads; ++i) threads.emplace_back([&io] { io.run(); });
+    io.run();
+    for (auto& t : threads) t.join();
+
+    auto& lat = stats.latencies_ns;
+    std::sort(lat.begin(), lat.end());
+    double secs = static_cast<double>(opts.duration);
+    auto us = [](long long ns) { return static_cast<double>(ns) / 1000.0; };
+    std::printf("clients=%zu logged_in=%llu failed=%llu rooms=%zu size=%zu duration=%ds\n",
+                opts.clients, static_cast<unsigned long long>(stats.logged_in.load()),
+                static_cast<unsigned long long>(stats.failed.load()), opts.rooms, opts.size,
+                opts.duration);
+    std::printf("sent=%llu (%.0f msg/s) received=%llu (%.0f msg/s)\n",
+                static_cast<unsigned long long>(stats.sent.load()),
+                static_cast<double>(stats.sent.load()) / secs,
+                static_cast<unsigned long long>(stats.received.load()),
+                static_cast<double>(stats.received.load()) / secs);
+    std::printf("rtt samples=%zu p50=%.0fus p90=%.0fus p99=%.0fus max=%.0fus\n", lat.size(),
+                us(percentile(lat, 0.50)), us(percentile(lat, 0.90)),
+                us(percentile(lat, 0.99)), us(lat.empty() ? 0 : lat.back()));
+    return stats.failed.load() == opts.clients ? 1 : 0;
+}